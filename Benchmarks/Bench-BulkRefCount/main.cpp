@@ -0,0 +1,87 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+class BenchObject
+{
+public:
+    constexpr BenchObject(size_t idx) noexcept : m_Index(idx) { };
+    constexpr BenchObject() noexcept = default;
+
+    constexpr size_t GetIndex() const noexcept { return m_Index; }
+
+private:
+    size_t m_Index = 0;
+};
+
+template<typename _Fn>
+static double Measure(_Fn&& fn) noexcept
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Objects are created in a shuffled order so that neighbouring Refs point to control blocks scattered across the heap
+static std::vector<Ref<BenchObject>> MakeRefs(size_t count, size_t duplicates) noexcept
+{
+    std::vector<Ref<BenchObject>> refs;
+    refs.reserve(count);
+
+    for (size_t i = 0; i < count; i += duplicates)
+    {
+        Ref<BenchObject> ref = CreateRef<BenchObject>(i);
+        for (size_t j = 0; (j < duplicates) && ((i + j) < count); ++j)
+            refs.push_back(ref);
+    }
+
+    if (duplicates == 1)
+        std::shuffle(refs.begin(), refs.end(), std::mt19937_64(42));
+
+    return refs;
+}
+
+static void RunBenchmark(const char* name, size_t count, size_t duplicates) noexcept
+{
+    std::vector<Ref<BenchObject>> refs = MakeRefs(count, duplicates);
+
+    std::vector<Ref<BenchObject>> copy;
+    double perElementCopy = Measure([&] { copy = refs; });
+    double perElementClear = Measure([&] { copy.clear(); });
+
+    double bulkCopy = Measure([&] { copy = CopyRefs(refs); });
+    double bulkClear = Measure([&] { ClearRefs(copy); });
+
+    std::cout << name << '\n';
+    std::cout << "    std::vector copy:  " << perElementCopy << " ms\n";
+    std::cout << "    CopyRefs:          " << bulkCopy << " ms\n";
+    std::cout << "    std::vector clear: " << perElementClear << " ms\n";
+    std::cout << "    ClearRefs:         " << bulkClear << " ms\n";
+
+    // Release the last references, destroying every object
+    double perElementDestroy = Measure([&] { refs.clear(); });
+    refs = MakeRefs(count, duplicates);
+    double bulkDestroy = Measure([&] { ClearRefs(refs); });
+
+    std::cout << "    std::vector destroy objects: " << perElementDestroy << " ms\n";
+    std::cout << "    ClearRefs destroy objects:   " << bulkDestroy << " ms\n\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Bench-BulkRefCount\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    constexpr size_t ELEMENT_COUNT = 10'000'000;
+
+    RunBenchmark("10M unique Refs (shuffled):", ELEMENT_COUNT, 1);
+    RunBenchmark("10M Refs, 8 adjacent duplicates each:", ELEMENT_COUNT, 8);
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+template<typename _Fn>
+static double Measure(_Fn&& fn) noexcept
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+#ifdef _INTRICATE_POSIX
+static constexpr const char* FILE_PATH = "Bench-MappedFile.log";
+static constexpr size_t LINE_COUNT = 4'000'000;
+static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+// The parsing stage, which only looks at the bytes of each record
+static uint64_t Consume(std::string_view record) noexcept
+{
+    uint64_t sum = record.size();
+    for (char c : record)
+        sum += static_cast<unsigned char>(c);
+
+    return sum;
+}
+
+static void WriteLog() noexcept
+{
+    FILE* file = std::fopen(FILE_PATH, "wb");
+    for (size_t i = 0; i < LINE_COUNT; ++i)
+        std::fprintf(file, "2024-01-01T00:00:00Z INFO request %zu served in %zu us\n", i, (i * 7919) % 100'000);
+
+    std::fclose(file);
+}
+
+// Reads the file in chunks and copies every record out of the buffer before handing it on
+static uint64_t RunReadCopy() noexcept
+{
+    int file = ::open(FILE_PATH, O_RDONLY);
+    std::vector<char> chunk(CHUNK_SIZE);
+    std::string pending;
+    uint64_t sum = 0;
+
+    for (ssize_t bytes; (bytes = ::read(file, chunk.data(), chunk.size())) > 0; )
+    {
+        size_t start = 0;
+        for (size_t i = 0; i < static_cast<size_t>(bytes); ++i)
+        {
+            if (chunk[i] != '\n')
+                continue;
+
+            pending.append(chunk.data() + start, i - start);
+            std::string record = std::move(pending);
+            sum += Consume(record);
+
+            pending.clear();
+            start = i + 1;
+        }
+
+        pending.append(chunk.data() + start, static_cast<size_t>(bytes) - start);
+    }
+
+    ::close(file);
+    return sum;
+}
+
+// Maps the file and hands every record on as a slice sharing the count of the mapping
+static uint64_t RunMappedFile(MappedAdvice advice) noexcept
+{
+    MappedSlice file = MappedFile::MapFile(FILE_PATH, advice);
+    std::string_view bytes = file.View();
+    uint64_t sum = 0;
+
+    for (size_t start = 0, end; (end = bytes.find('\n', start)) != std::string_view::npos; start = end + 1)
+    {
+        MappedSlice record = file.Slice(start, end - start);
+        sum += Consume(record.View());
+    }
+
+    return sum;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Bench-MappedFile\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+#ifdef _INTRICATE_POSIX
+    WriteLog();
+
+    // Both runs read from the page cache, the first pass warms it
+    uint64_t expected = RunReadCopy();
+    uint64_t readSum = 0, sequentialSum = 0, normalSum = 0;
+
+    double readCopy = Measure([&] { readSum = RunReadCopy(); });
+    double sequential = Measure([&] { sequentialSum = RunMappedFile(MappedAdvice::Sequential | MappedAdvice::WillNeed); });
+    double normal = Measure([&] { normalSum = RunMappedFile(MappedAdvice::Normal); });
+
+    std::cout << "4M log lines:\n";
+    std::cout << "    read() + copy:                     " << readCopy << " ms\n";
+    std::cout << "    MappedFile, Sequential | WillNeed: " << sequential << " ms\n";
+    std::cout << "    MappedFile, Normal:                " << normal << " ms\n";
+    std::cout << "    checksums " << ((readSum == expected) && (sequentialSum == expected) && (normalSum == expected) ? "match" : "DIFFER") << '\n';
+
+    std::remove(FILE_PATH);
+#else
+    std::cout << "MappedFile requires POSIX mmap\n";
+#endif
+
+    std::cin.get();
+    return 0;
+}
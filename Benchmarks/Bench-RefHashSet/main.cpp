@@ -0,0 +1,92 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <unordered_set>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+class BenchObject
+{
+public:
+    constexpr BenchObject(size_t idx) noexcept : m_Index(idx) { };
+    constexpr BenchObject() noexcept = default;
+
+    constexpr size_t GetIndex() const noexcept { return m_Index; }
+
+private:
+    size_t m_Index = 0;
+};
+
+template<typename _Fn>
+static double Measure(_Fn&& fn) noexcept
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename _Set>
+static void RunStdSet(const char* name, const std::vector<Ref<BenchObject>>& keys, const std::vector<Ref<BenchObject>>& lookups) noexcept
+{
+    _Set set;
+    size_t found = 0;
+
+    double insert = Measure([&] { for (const Ref<BenchObject>& key : keys) set.insert(key); });
+    double find = Measure([&] { for (const Ref<BenchObject>& key : lookups) found += set.count(key); });
+    double erase = Measure([&] { for (const Ref<BenchObject>& key : keys) set.erase(key); });
+
+    std::cout << name << '\n';
+    std::cout << "    insert: " << insert << " ms\n";
+    std::cout << "    find:   " << find << " ms (" << found << " hits)\n";
+    std::cout << "    erase:  " << erase << " ms\n";
+}
+
+static void RunRefHashSet(const std::vector<Ref<BenchObject>>& keys, const std::vector<Ref<BenchObject>>& lookups) noexcept
+{
+    RefHashSet<BenchObject> set;
+    size_t found = 0;
+
+    double insert = Measure([&] { for (const Ref<BenchObject>& key : keys) set.Insert(key); });
+    double find = Measure([&] { for (const Ref<BenchObject>& key : lookups) found += set.Contains(key.Raw()); });
+    double erase = Measure([&] { for (const Ref<BenchObject>& key : keys) set.Erase(key.Raw()); });
+
+    std::cout << "RefHashSet:\n";
+    std::cout << "    insert: " << insert << " ms\n";
+    std::cout << "    find:   " << find << " ms (" << found << " hits)\n";
+    std::cout << "    erase:  " << erase << " ms\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Bench-RefHashSet\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    constexpr size_t KEY_COUNT = 1'000'000;
+    constexpr size_t LOOKUP_COUNT = 10'000'000;
+
+    std::vector<Ref<BenchObject>> keys;
+    keys.reserve(KEY_COUNT * 2);
+    for (size_t i = 0; i < KEY_COUNT * 2; ++i)
+        keys.push_back(CreateRef<BenchObject>(i));
+
+    // Half of the lookups miss
+    std::mt19937_64 rng(42);
+    std::vector<Ref<BenchObject>> lookups;
+    lookups.reserve(LOOKUP_COUNT);
+    for (size_t i = 0; i < LOOKUP_COUNT; ++i)
+        lookups.push_back(keys[rng() % keys.size()]);
+
+    keys.resize(KEY_COUNT);
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    std::cout << "1M keys, 10M lookups:\n\n";
+    RunStdSet<std::unordered_set<Ref<BenchObject>>>("std::unordered_set, std::hash<Ref>:", keys, lookups);
+    RunStdSet<std::unordered_set<Ref<BenchObject>, RefHash<BenchObject>, RefEqual<BenchObject>>>("std::unordered_set, RefHash:", keys, lookups);
+    RunRefHashSet(keys, lookups);
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+class BenchObject
+{
+public:
+    constexpr BenchObject(size_t idx) noexcept : m_Index(idx) { };
+    constexpr BenchObject() noexcept = default;
+
+    constexpr size_t GetIndex() const noexcept { return m_Index; }
+
+private:
+    size_t m_Index = 0;
+};
+
+template<typename _Fn>
+static double Measure(_Fn&& fn) noexcept
+{
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Pushes count copies of a single Ref, so every push and every element moved by a regrowth touches the same count
+static void RunSharedRef(size_t count) noexcept
+{
+    Ref<BenchObject> ref = CreateRef<BenchObject>(0);
+
+    double stdPush = 0.0;
+    double stdClear = 0.0;
+    {
+        std::vector<Ref<BenchObject>> vec;
+        stdPush = Measure([&] { for (size_t i = 0; i < count; ++i) vec.push_back(ref); });
+        stdClear = Measure([&] { vec.clear(); });
+    }
+
+    double relocPush = 0.0;
+    double relocClear = 0.0;
+    {
+        RelocVector<Ref<BenchObject>> vec;
+        relocPush = Measure([&] { for (size_t i = 0; i < count; ++i) vec.PushBack(ref); });
+        relocClear = Measure([&] { vec.Clear(); });
+    }
+
+    std::cout << "10M copies of one Ref:\n";
+    std::cout << "    std::vector push_back: " << stdPush << " ms\n";
+    std::cout << "    RelocVector PushBack:  " << relocPush << " ms\n";
+    std::cout << "    std::vector clear:     " << stdClear << " ms\n";
+    std::cout << "    RelocVector Clear:     " << relocClear << " ms\n\n";
+}
+
+// Moves count unique Refs in, so only the regrowths differ between the two containers
+static void RunUniqueRefs(size_t count) noexcept
+{
+    std::vector<Ref<BenchObject>> refs;
+    refs.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+        refs.push_back(CreateRef<BenchObject>(i));
+
+    double stdGrow = 0.0;
+    {
+        std::vector<Ref<BenchObject>> vec;
+        stdGrow = Measure([&] { for (Ref<BenchObject>& ref : refs) vec.push_back(std::move(ref)); });
+        for (size_t i = 0; i < count; ++i)
+            refs[i] = std::move(vec[i]);
+    }
+
+    double relocGrow = 0.0;
+    {
+        RelocVector<Ref<BenchObject>> vec;
+        relocGrow = Measure([&] { for (Ref<BenchObject>& ref : refs) vec.PushBack(std::move(ref)); });
+        for (size_t i = 0; i < count; ++i)
+            refs[i] = std::move(vec[i]);
+    }
+
+    std::cout << "10M unique Refs moved in:\n";
+    std::cout << "    std::vector push_back: " << stdGrow << " ms\n";
+    std::cout << "    RelocVector PushBack:  " << relocGrow << " ms\n\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Bench-RelocVector\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    constexpr size_t ELEMENT_COUNT = 10'000'000;
+
+    RunSharedRef(ELEMENT_COUNT);
+    RunUniqueRefs(ELEMENT_COUNT);
+
+    std::cin.get();
+    return 0;
+}
@@ -30,8 +30,11 @@ public:
     constexpr BaseClass(int number) noexcept : m_Number(number) { };
     BaseClass() = default;
 
-    // This destructor must be marked virtual to allow the destructors of any child classes to also be called when this object is free'd.
-    virtual ~BaseClass() noexcept
+    // This destructor does not need to be virtual, a Ref destroys its object as the type it was created as.
+    // The Ref<BaseClass> below still calls DerivedClass's destructor since it was created by CreateRef<DerivedClass>.
+    // Release() on such a Ref<BaseClass> returns nullptr and keeps the reference, since deleting the object as a BaseClass*
+    // would skip DerivedClass's destructor. A BaseClass* obtained any other way must not be deleted either.
+    ~BaseClass() noexcept
     {
         std::cout << "BaseClass .dtor called on " << this << '\n';
     }
@@ -45,13 +48,13 @@ protected:
     int m_Number;
 };
 
-class DerivedClass : public BaseClass
+class DerivedClass final : public BaseClass
 {
 public:
     constexpr DerivedClass(int number) noexcept : BaseClass(number) { };
 
     // This destructor will always be called before BaseClass's destructor.
-    virtual ~DerivedClass() noexcept
+    ~DerivedClass() noexcept
     {
         std::cout << "DerivedClass .dtor called on " << this << '\n';
     }
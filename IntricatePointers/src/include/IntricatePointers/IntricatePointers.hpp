@@ -20,8 +20,27 @@
 #pragma once
 #include <ostream>
 #include <type_traits>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <functional>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <unordered_map>
 #include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
 
 
 #ifndef INTRICATE_OMIT_NAMESPACE
@@ -34,6 +53,27 @@
     #define _INTRICATE
 #endif // !INTRICATE_OMIT_NAMESPACE
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #define _INTRICATE_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#elif defined(__GNUC__) || defined(__clang__)
+    #define _INTRICATE_PREFETCH(addr) __builtin_prefetch((addr), 1)
+#else
+    #define _INTRICATE_PREFETCH(addr) ((void)(addr))
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define _INTRICATE_POSIX
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <signal.h>
+    #include <pthread.h>
+    #include <cerrno>
+#endif
+
 INTRICATE_NAMESPACE_BEGIN
 
 template<typename _Ty>
@@ -70,7 +110,7 @@ public:
     template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
     constexpr void Reset(_Ty2* newPtr) noexcept
     {
-        Scope<_Ty2>(newPtr).Swap(*this);
+        Scope<_Ty>(newPtr).Swap(*this);
     }
 
     constexpr void Reset(_Ty* newPtr) noexcept
@@ -145,33 +185,327 @@ constexpr static _WantedType* GetScopeBaseTypePtr(const Scope<_ScopeType>& scope
     return static_cast<_WantedType*>(scope.Raw());
 }
 
-class _AtomicRefCount
+// Scope deletes through its own type, so a Scope must only ever be cast back to the type it was created as or to a base with a virtual destructor
+template<typename _Ty, typename _Ty2>
+constexpr static Scope<_Ty> StaticScopeCast(Scope<_Ty2>&& scope) noexcept
+{
+    return Scope<_Ty>(static_cast<_Ty*>(scope.Release()));
+}
+
+// Leaves scope untouched and returns nullptr if the object is not a _Ty
+template<typename _Ty, typename _Ty2>
+constexpr static Scope<_Ty> DynamicScopeCast(Scope<_Ty2>&& scope) noexcept
+{
+    if (!dynamic_cast<_Ty*>(scope.Raw()))
+        return nullptr;
+
+    return Scope<_Ty>(dynamic_cast<_Ty*>(scope.Release()));
+}
+
+template<typename _Ty, typename _Ty2>
+constexpr static Scope<_Ty> ConstScopeCast(Scope<_Ty2>&& scope) noexcept
+{
+    return Scope<_Ty>(const_cast<_Ty*>(scope.Release()));
+}
+
+// Owns a single polymorphic object derived from _Base. Types that fit _Capacity and _Align and are nothrow move constructible are
+// constructed in the inline storage, anything else falls back to the heap. The object is always destroyed as its own type, so
+// _Base needs no virtual destructor. Moving an inline object relocates it through a function recorded when it was constructed.
+template<typename _Base, size_t _Capacity = 64, size_t _Align = alignof(std::max_align_t)>
+class InlineScope
 {
 public:
-    constexpr _AtomicRefCount() noexcept = default;
-    constexpr ~_AtomicRefCount() noexcept = default;
+    template<typename _Ty2>
+    static constexpr bool FitsInline = (sizeof(_Ty2) <= _Capacity) && (alignof(_Ty2) <= _Align) && std::is_nothrow_move_constructible_v<_Ty2>;
 
-    _AtomicRefCount(const _AtomicRefCount&) = delete;
-    _AtomicRefCount& operator=(const _AtomicRefCount&) = delete;
+public:
+    InlineScope(InlineScope&& other) noexcept { _MoveFrom(other); }
+
+    InlineScope(const InlineScope&) = delete;
+    constexpr InlineScope(std::nullptr_t) noexcept { };
+    constexpr InlineScope() noexcept = default;
+
+    ~InlineScope() noexcept
+    {
+        Reset();
+    }
+
+    // The new object is constructed before the current one is destroyed, so args may refer to the current object.
+    // Replacing an inline object therefore costs one extra relocation.
+    template<typename _Ty2, typename... _Args, std::enable_if_t<std::is_base_of_v<_Base, _Ty2>, int> = 0>
+    _Ty2& Emplace(_Args&&... args) noexcept
+    {
+        if (!m_Ptr)
+            return _Construct<_Ty2>(std::forward<_Args>(args)...);
+
+        InlineScope temp;
+        _Ty2* object = &temp.template _Construct<_Ty2>(std::forward<_Args>(args)...);
+        *this = std::move(temp);
+
+        if constexpr (FitsInline<_Ty2>)
+            object = std::launder(reinterpret_cast<_Ty2*>(m_Storage));
+
+        return *object;
+    }
+
+    void Reset() noexcept
+    {
+        if (m_Ptr)
+            m_Ops->Destroy(std::exchange(m_Ptr, nullptr));
+
+        m_Ops = nullptr;
+    }
+
+    void Swap(InlineScope& other) noexcept
+    {
+        if (this == &other)
+            return;
+
+        InlineScope temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    constexpr _Base* Raw() const noexcept
+    {
+        return m_Ptr;
+    }
+
+    constexpr bool Valid() const noexcept
+    {
+        return Raw() != nullptr;
+    }
+
+    // Whether the object lives in the inline storage rather than on the heap
+    constexpr bool IsInline() const noexcept
+    {
+        return m_Ptr && m_Ops->Relocate;
+    }
+
+    constexpr explicit operator bool() const noexcept { return Valid(); }
+
+    InlineScope& operator=(const InlineScope&) = delete;
+
+    InlineScope& operator=(InlineScope&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            _MoveFrom(other);
+        }
+
+        return *this;
+    }
+
+    InlineScope& operator=(std::nullptr_t) noexcept
+    {
+        Reset();
+        return *this;
+    }
+
+    constexpr _Base* operator->() const noexcept { return Raw(); }
+    constexpr _Base& operator*() const noexcept { return *Raw(); }
+
+private:
+    struct _InlineScopeOps
+    {
+        void (*Destroy)(_Base*) noexcept;
+        _Base* (*Relocate)(void* dst, _Base* src) noexcept;     // nullptr for heap objects, which move by pointer
+    };
+
+    template<typename _Ty2>
+    struct _Ops
+    {
+        static void _Destroy(_Base* ptr) noexcept
+        {
+            _Ty2* object = static_cast<_Ty2*>(ptr);
+            object->~_Ty2();
+
+            if constexpr (!FitsInline<_Ty2>)
+                ::operator delete(object, std::align_val_t(alignof(_Ty2)));
+        }
+
+        static _Base* _Relocate(void* dst, _Base* src) noexcept
+        {
+            _Ty2* from = static_cast<_Ty2*>(src);
+            _Ty2* to = new (dst) _Ty2(std::move(*from));
+            from->~_Ty2();
+            return to;
+        }
+
+        static constexpr _InlineScopeOps s_Ops{ &_Destroy, FitsInline<_Ty2> ? &_Relocate : nullptr };
+    };
+
+    // Constructs into this InlineScope, which must be empty
+    template<typename _Ty2, typename... _Args>
+    _Ty2& _Construct(_Args&&... args) noexcept
+    {
+        _Ty2* object;
+        if constexpr (FitsInline<_Ty2>)
+            object = new (m_Storage) _Ty2(std::forward<_Args>(args)...);
+        else
+            object = new (::operator new(sizeof(_Ty2), std::align_val_t(alignof(_Ty2)))) _Ty2(std::forward<_Args>(args)...);
+
+        m_Ptr = object;
+        m_Ops = &_Ops<_Ty2>::s_Ops;
+        return *object;
+    }
+
+    void _MoveFrom(InlineScope& other) noexcept
+    {
+        if (!other.m_Ptr)
+            return;
+
+        m_Ops = other.m_Ops;
+        m_Ptr = m_Ops->Relocate ? m_Ops->Relocate(m_Storage, other.m_Ptr) : other.m_Ptr;
+        other.m_Ptr = nullptr;
+        other.m_Ops = nullptr;
+    }
+
+private:
+    alignas(_Align) std::byte m_Storage[_Capacity];
+    _Base* m_Ptr = nullptr;
+    const _InlineScopeOps* m_Ops = nullptr;
+};
+
+template<typename _Base, typename _Ty, size_t _Capacity = 64, size_t _Align = alignof(std::max_align_t), typename... _Args>
+static InlineScope<_Base, _Capacity, _Align> CreateInlineScope(_Args&&... args) noexcept
+{
+    InlineScope<_Base, _Capacity, _Align> scope;
+    scope.template Emplace<_Ty>(std::forward<_Args>(args)...);
+    return scope;
+}
+
+// Specialize this trait to std::false_type for types that are never observed through a WeakRef.
+// Refs to such types use a control block holding a single strong counter and WeakRef<_Ty> will fail to compile.
+template<typename _Ty>
+struct EnableWeakRefs : std::true_type { };
+
+template<typename _Ty>
+constexpr bool _EnableWeakRefsV = EnableWeakRefs<std::remove_cv_t<_Ty>>::value;
+
+// Specialize this trait to std::true_type to have the final Ref release hand the object to the deferred destruction queue
+// instead of destroying it on the releasing thread. Queued objects are destroyed by DrainDeferred() or a DeferredReclaimer.
+template<typename _Ty>
+struct DeferRefDestruction : std::false_type { };
+
+template<typename _Ty>
+constexpr bool _DeferRefDestructionV = DeferRefDestruction<std::remove_cv_t<_Ty>>::value;
+
+// Whether a Ref<_Ty2> can be converted to a Ref<_Ty>, which covers derived-to-base, adding const and erasing to void
+template<typename _Ty2, typename _Ty>
+constexpr bool _IsPtrConvertibleV = std::is_convertible_v<_Ty2*, _Ty*>;
+
+class _AtomicStrongRefCount;
+
+// Type-erased operations of a control block, shared by every control block with the same layout and object type
+struct _RefCountOps
+{
+    void (*Destroy)(_AtomicStrongRefCount*) noexcept;   // Destroys the owned object
+    void (*Free)(_AtomicStrongRefCount*) noexcept;      // Releases the storage of the control block
+    void* (*GetObject)(const _AtomicStrongRefCount*) noexcept;  // Address of the owned object as the type it was created as
+    bool Deferred;                                      // DeferRefDestruction of the type the object was created as
+    void (*ReleaseObject)(_AtomicStrongRefCount*) noexcept = nullptr;   // Optional, does the work of ReleaseObject() in a single call
+};
+
+// Control block used by Ref when the type has opted out of weak references.
+// Besides the strong count it keeps a pointer to its ops, and the final release makes one indirect call through them
+// rather than freeing inline. That extra word lets the same block defer destruction and destroy the object as the type it
+// was created as, though with padding it leaves the block as large as _AtomicRefCount on 64-bit targets. What opting out
+// saves is the weak count decrement on every final release.
+class _AtomicStrongRefCount
+{
+public:
+    constexpr explicit _AtomicStrongRefCount(const _RefCountOps* ops) noexcept : m_Ops(ops) { };
+    constexpr ~_AtomicStrongRefCount() noexcept = default;
+
+    _AtomicStrongRefCount(const _AtomicStrongRefCount&) = delete;
+    _AtomicStrongRefCount& operator=(const _AtomicStrongRefCount&) = delete;
 
     uint32_t GetStrongs() const noexcept
     {
         return m_Strongs.load(std::memory_order_acquire);
     }
 
-    uint32_t GetWeaks() const noexcept
+    uint32_t IncRef(uint32_t count = 1) noexcept
     {
-        return m_Weaks.load(std::memory_order_acquire);
+        return m_Strongs.fetch_add(count, std::memory_order_relaxed) + count;
+    }
+
+    uint32_t DecRef(uint32_t count = 1) noexcept
+    {
+        return m_Strongs.fetch_sub(count, std::memory_order_acq_rel) - count;
+    }
+
+    // Increments the strong count unless it has already reached zero, in which case the object is gone
+    bool TryIncRef() noexcept
+    {
+        uint32_t strongs = m_Strongs.load(std::memory_order_relaxed);
+        while (strongs != 0)
+        {
+            if (m_Strongs.compare_exchange_weak(strongs, strongs + 1, std::memory_order_relaxed))
+                return true;
+        }
+
+        return false;
+    }
+
+    const _RefCountOps* GetOps() const noexcept
+    {
+        return m_Ops;
+    }
+
+    void* GetObject() const noexcept
+    {
+        return m_Ops->GetObject(this);
+    }
+
+    // Called once the strong count has reached zero
+    void ReleaseObject() noexcept
+    {
+        if (m_Ops->ReleaseObject)
+            return m_Ops->ReleaseObject(this);
+
+        _DestroyObject();
+        _FreeBlock();
+    }
+
+    // Called once the strong count has reached zero after ownership of the object was given up through Ref::Release(),
+    // which only happens for _RefCountPtr blocks
+    void AbandonObject() noexcept
+    {
+        _FreeBlock();
+    }
+
+protected:
+    void _DestroyObject() noexcept
+    {
+        m_Ops->Destroy(this);
     }
 
-    uint32_t IncRef() noexcept
+    void _FreeBlock() noexcept
     {
-        return m_Strongs.fetch_add(1, std::memory_order_relaxed) + 1;
+        m_Ops->Free(this);
     }
 
-    uint32_t DecRef() noexcept
+private:
+    const _RefCountOps* m_Ops;
+    std::atomic_uint m_Strongs = 1;
+};
+
+class _AtomicRefCount : public _AtomicStrongRefCount
+{
+public:
+    constexpr explicit _AtomicRefCount(const _RefCountOps* ops) noexcept : _AtomicStrongRefCount(ops) { };
+    constexpr ~_AtomicRefCount() noexcept = default;
+
+    _AtomicRefCount(const _AtomicRefCount&) = delete;
+    _AtomicRefCount& operator=(const _AtomicRefCount&) = delete;
+
+    // Includes the weak reference held collectively by the strong references until the object is destroyed
+    uint32_t GetWeaks() const noexcept
     {
-        return m_Strongs.fetch_sub(1, std::memory_order_acq_rel) - 1;
+        return m_Weaks.load(std::memory_order_acquire);
     }
 
     uint32_t IncWeakRef() noexcept
@@ -184,402 +518,4959 @@ public:
         return m_Weaks.fetch_sub(1, std::memory_order_acq_rel) - 1;
     }
 
+    // Called once the strong count has reached zero
+    void ReleaseObject() noexcept
+    {
+        if (GetOps()->ReleaseObject)
+            return GetOps()->ReleaseObject(this);
+
+        _DestroyObject();
+        ReleaseWeak();
+    }
+
+    // Called once the strong count has reached zero after ownership of the object was given up through Ref::Release(),
+    // which only happens for _RefCountPtr blocks
+    void AbandonObject() noexcept
+    {
+        ReleaseWeak();
+    }
+
+    void ReleaseWeak() noexcept
+    {
+        if (DecWeakRef() == 0)
+            _FreeBlock();
+    }
+
 private:
-    std::atomic_uint m_Strongs = 1;
-    std::atomic_uint m_Weaks = 0;
+    std::atomic_uint m_Weaks = 1;
 };
 
 template<typename _Ty>
-class Ref;
-
-template<typename _Ty>
-class WeakRef;
+using _RefCountType = std::conditional_t<_EnableWeakRefsV<_Ty>, _AtomicRefCount, _AtomicStrongRefCount>;
 
-// Base class for Ref and WeakRef
-// std::remove_extent<> will need to be used in future to support array types.
-template<typename _Ty>
-class _RefBase
+// Control block for an object that was allocated on its own with new
+template<typename _Ty, typename _RefCount>
+class _RefCountPtr : public _RefCount
 {
-protected:
-    constexpr _RefBase(std::nullptr_t) noexcept : m_Ptr(nullptr), m_RefCount(nullptr) { };
-    constexpr _RefBase() noexcept = default;
-    constexpr ~_RefBase() noexcept = default;
-
 public:
-    _RefBase(const _RefBase<_Ty>&) = delete;
-    _RefBase<_Ty>& operator=(const _RefBase<_Ty>&) = delete;
+    constexpr explicit _RefCountPtr(_Ty* ptr) noexcept : _RefCount(&s_Ops), m_Owned(ptr) { };
 
-protected:
-    constexpr _Ty* _Raw() const noexcept
+    // Whether refCount is a block of this type and ptr the object it owns, which can then be deleted as a _Ty*
+    static bool Owns(const _AtomicStrongRefCount* refCount, const volatile void* ptr) noexcept
     {
-        return m_Ptr;
+        return (refCount->GetOps() == &s_Ops) && (static_cast<const _RefCountPtr*>(refCount)->m_Owned == ptr);
     }
 
-    constexpr void _Swap(_RefBase<_Ty>& other) noexcept
+private:
+    static void _Destroy(_AtomicStrongRefCount* refCount) noexcept
     {
-        std::swap(m_Ptr, other.m_Ptr);
-        std::swap(m_RefCount, other.m_RefCount);
+        delete static_cast<_RefCountPtr*>(refCount)->m_Owned;
     }
 
-    uint32_t _RefCount() const noexcept
+    static void _Free(_AtomicStrongRefCount* refCount) noexcept
     {
-        return m_RefCount ? m_RefCount->GetStrongs() : 0;
+        delete static_cast<_RefCountPtr*>(refCount);
     }
 
-    uint32_t _WeakRefCount() const noexcept
+    static void* _GetObject(const _AtomicStrongRefCount* refCount) noexcept
     {
-        return m_RefCount ? m_RefCount->GetWeaks() : 0;
+        return const_cast<std::remove_cv_t<_Ty>*>(static_cast<const _RefCountPtr*>(refCount)->m_Owned);
     }
 
-    void _IncRef() noexcept
+    // Deletes the object and then the block directly, so the final release of a plain Ref costs one indirect call
+    static void _ReleaseObject(_AtomicStrongRefCount* refCount) noexcept
     {
-        if (m_RefCount)
-            (void)m_RefCount->IncRef();
+        _RefCountPtr* block = static_cast<_RefCountPtr*>(refCount);
+        delete block->m_Owned;
+
+        if constexpr (std::is_same_v<_RefCount, _AtomicRefCount>)
+        {
+            if (block->DecWeakRef() != 0)
+                return;
+        }
+
+        delete block;
     }
 
-    void _DecRef() noexcept
+private:
+    static constexpr _RefCountOps s_Ops{ &_Destroy, &_Free, &_GetObject, _DeferRefDestructionV<_Ty>, &_ReleaseObject };
+
+    _Ty* m_Owned;
+};
+
+struct DeferredDestructionStats
+{
+    uint64_t QueueDepth = 0;
+    uint64_t PeakQueueDepth = 0;
+    uint64_t TotalEnqueued = 0;
+    uint64_t TotalDestroyed = 0;
+    std::chrono::nanoseconds TotalDestructionTime{ 0 };
+    std::chrono::nanoseconds MaxDestructionTime{ 0 };
+};
+
+// Lock-free multi-producer stack of objects awaiting destruction.
+// Each drain pass detaches the whole stack and destroys it oldest first. Whatever a pass leaves over once its budget
+// runs out is kept in a private FIFO that the next pass drains before the stack, so objects are always destroyed in
+// the order they were enqueued.
+class _DeferredDestructionQueue
+{
+public:
+    static _DeferredDestructionQueue& Get() noexcept
     {
-        if (m_RefCount && (m_RefCount->DecRef() == 0))
+        static _DeferredDestructionQueue s_Instance;
+        return s_Instance;
+    }
+
+    ~_DeferredDestructionQueue() noexcept
+    {
+        (void)Drain(SIZE_MAX);
+    }
+
+    _DeferredDestructionQueue(const _DeferredDestructionQueue&) = delete;
+    _DeferredDestructionQueue& operator=(const _DeferredDestructionQueue&) = delete;
+
+    // Takes over a control block whose strong count has reached zero
+    template<typename _RefCount>
+    void Enqueue(_RefCount* refCount) noexcept
+    {
+        _Node* node = new (std::nothrow) _Node{ nullptr, refCount, &_ReleaseObject<_RefCount> };
+        if (!node)
+        {
+            // Destroying inline is preferable to leaking the object
+            refCount->ReleaseObject();
+            return;
+        }
+
+        _Push(node, node);
+
+        m_Enqueued.fetch_add(1, std::memory_order_relaxed);
+        uint64_t depth = m_Depth.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint64_t peak = m_PeakDepth.load(std::memory_order_relaxed);
+        while ((depth > peak) && !m_PeakDepth.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) { }
+    }
+
+    size_t Drain(size_t maxObjects) noexcept
+    {
+        // Recursive, since the destructors run here may drain the queue themselves
+        std::lock_guard<std::recursive_mutex> lock(m_DrainMutex);
+
+        size_t destroyed = 0;
+        while (destroyed < maxObjects)
         {
-            if (m_Ptr)
+            _Node* list = std::exchange(m_Remainder, nullptr);
+            if (!list)
+                list = _Reverse(m_Head.exchange(nullptr, std::memory_order_acquire));
+
+            if (!list)
+                break;
+
+            while (list && (destroyed < maxObjects))
             {
-                delete m_Ptr;
-                m_Ptr = nullptr;
+                _Node* node = std::exchange(list, list->Next);
+
+                auto start = std::chrono::steady_clock::now();
+                node->Destroy(node->Ptr);
+                int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+                delete node;
+                ++destroyed;
+
+                m_Depth.fetch_sub(1, std::memory_order_relaxed);
+                m_Destroyed.fetch_add(1, std::memory_order_relaxed);
+                m_DestructionTime.fetch_add(elapsed, std::memory_order_relaxed);
+                int64_t maxElapsed = m_MaxDestructionTime.load(std::memory_order_relaxed);
+                while ((elapsed > maxElapsed) && !m_MaxDestructionTime.compare_exchange_weak(maxElapsed, elapsed, std::memory_order_relaxed)) { }
             }
 
-            if (_WeakRefCount() == 0)
+            // Out of budget, keep the remainder ahead of everything enqueued since. A drain nested in one of the
+            // destructors only ever leaves over newer objects than this one.
+            if (list)
             {
-                delete m_RefCount;
-                m_RefCount = nullptr;
+                _Node* tail = list;
+                while (tail->Next)
+                    tail = tail->Next;
+
+                tail->Next = m_Remainder;
+                m_Remainder = list;
             }
         }
+
+        return destroyed;
     }
 
-    void _IncWeakRef() noexcept
+    DeferredDestructionStats GetStats() const noexcept
     {
-        if (m_RefCount)
-            (void)m_RefCount->IncWeakRef();
+        DeferredDestructionStats stats;
+        stats.QueueDepth = m_Depth.load(std::memory_order_relaxed);
+        stats.PeakQueueDepth = m_PeakDepth.load(std::memory_order_relaxed);
+        stats.TotalEnqueued = m_Enqueued.load(std::memory_order_relaxed);
+        stats.TotalDestroyed = m_Destroyed.load(std::memory_order_relaxed);
+        stats.TotalDestructionTime = std::chrono::nanoseconds(m_DestructionTime.load(std::memory_order_relaxed));
+        stats.MaxDestructionTime = std::chrono::nanoseconds(m_MaxDestructionTime.load(std::memory_order_relaxed));
+
+        return stats;
+    }
+
+private:
+    _DeferredDestructionQueue() noexcept = default;
+
+    struct _Node
+    {
+        _Node* Next;
+        void* Ptr;
+        void (*Destroy)(void*) noexcept;
+    };
+
+    template<typename _RefCount>
+    static void _ReleaseObject(void* refCount) noexcept
+    {
+        static_cast<_RefCount*>(refCount)->ReleaseObject();
+    }
+
+    static _Node* _Reverse(_Node* list) noexcept
+    {
+        _Node* res = nullptr;
+        while (list)
+        {
+            _Node* next = list->Next;
+            list->Next = res;
+            res = list;
+            list = next;
+        }
+
+        return res;
+    }
+
+    void _Push(_Node* head, _Node* tail) noexcept
+    {
+        tail->Next = m_Head.load(std::memory_order_relaxed);
+        while (!m_Head.compare_exchange_weak(tail->Next, head, std::memory_order_release, std::memory_order_relaxed)) { }
+    }
+
+private:
+    std::atomic<_Node*> m_Head = nullptr;
+
+    std::recursive_mutex m_DrainMutex;
+    _Node* m_Remainder = nullptr;       // Oldest first, guarded by m_DrainMutex
+
+    std::atomic_uint64_t m_Depth = 0;
+    std::atomic_uint64_t m_PeakDepth = 0;
+    std::atomic_uint64_t m_Enqueued = 0;
+    std::atomic_uint64_t m_Destroyed = 0;
+    std::atomic_int64_t m_DestructionTime = 0;
+    std::atomic_int64_t m_MaxDestructionTime = 0;
+};
+
+// Destroys the object of a control block whose strong count reached zero, or queues it if its type defers destruction
+template<typename _RefCount>
+inline void _ReleaseOrDefer(_RefCount* refCount) noexcept
+{
+    if (refCount->GetOps()->Deferred)
+        _DeferredDestructionQueue::Get().Enqueue(refCount);
+    else
+        refCount->ReleaseObject();
+}
+
+// Destroys up to maxObjects queued objects on the calling thread and returns how many were destroyed.
+// Objects released by those destructors are also drained as long as the budget allows.
+inline size_t DrainDeferred(size_t maxObjects = SIZE_MAX) noexcept
+{
+    return _DeferredDestructionQueue::Get().Drain(maxObjects);
+}
+
+inline DeferredDestructionStats GetDeferredDestructionStats() noexcept
+{
+    return _DeferredDestructionQueue::Get().GetStats();
+}
+
+// Drains the deferred destruction queue on a background thread every interval until destroyed
+class DeferredReclaimer
+{
+public:
+    explicit DeferredReclaimer(std::chrono::milliseconds interval = std::chrono::milliseconds(1))
+        : m_Interval(interval), m_Thread([this](std::stop_token stopToken) { _Run(stopToken); }) { };
+
+    ~DeferredReclaimer() noexcept
+    {
+        m_Thread.request_stop();
+        m_Thread.join();
+
+        (void)DrainDeferred();
+    }
+
+    DeferredReclaimer(const DeferredReclaimer&) = delete;
+    DeferredReclaimer& operator=(const DeferredReclaimer&) = delete;
+
+    // Drain now instead of waiting for the interval to elapse
+    void Wake() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_WakeRequested = true;
+        }
+
+        m_Condition.notify_one();
+    }
+
+private:
+    void _Run(std::stop_token stopToken) noexcept
+    {
+        while (!stopToken.stop_requested())
+        {
+            (void)DrainDeferred();
+
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            (void)m_Condition.wait_for(lock, stopToken, m_Interval, [this] { return std::exchange(m_WakeRequested, false); });
+        }
+    }
+
+private:
+    std::chrono::milliseconds m_Interval;
+    std::mutex m_Mutex;
+    std::condition_variable_any m_Condition;
+    bool m_WakeRequested = false;
+    std::jthread m_Thread;
+};
+
+template<typename _Ty>
+class Ref;
+
+struct _RefAccess;
+
+template<typename _Ty>
+class WeakRef;
+
+template<typename _Ty>
+class EnableRefFromThis;
+
+template<typename _Ty, typename = void>
+struct _HasRefFromThis : std::false_type { };
+
+template<typename _Ty>
+struct _HasRefFromThis<_Ty, std::void_t<typename _Ty::_RefFromThisType>> : std::true_type { };
+
+template<typename _Ty>
+constexpr bool _HasRefFromThisV = _HasRefFromThis<_Ty>::value;
+
+// Base class for Ref and WeakRef
+// std::remove_extent<> will need to be used in future to support array types.
+template<typename _Ty>
+class _RefBase
+{
+protected:
+    constexpr _RefBase(std::nullptr_t) noexcept : m_Ptr(nullptr), m_RefCount(nullptr) { };
+    constexpr _RefBase() noexcept = default;
+    constexpr ~_RefBase() noexcept = default;
+
+public:
+    _RefBase(const _RefBase<_Ty>&) = delete;
+    _RefBase<_Ty>& operator=(const _RefBase<_Ty>&) = delete;
+
+protected:
+    constexpr _Ty* _Raw() const noexcept
+    {
+        return m_Ptr;
+    }
+
+    constexpr void _Swap(_RefBase<_Ty>& other) noexcept
+    {
+        std::swap(m_Ptr, other.m_Ptr);
+        std::swap(m_RefCount, other.m_RefCount);
+    }
+
+    uint32_t _RefCount() const noexcept
+    {
+        return m_RefCount ? m_RefCount->GetStrongs() : 0;
+    }
+
+    void _IncRef() noexcept
+    {
+        if (m_RefCount)
+            (void)m_RefCount->IncRef();
+    }
+
+    void _DecRef() noexcept
+    {
+        if (m_RefCount && (m_RefCount->DecRef() == 0))
+        {
+            _ReleaseOrDefer(m_RefCount);
+
+            m_Ptr = nullptr;
+            m_RefCount = nullptr;
+        }
+    }
+
+    // Drops this reference without destroying the object, even if it was the last one
+    void _Abandon() noexcept
+    {
+        if (m_RefCount && (m_RefCount->DecRef() == 0))
+            m_RefCount->AbandonObject();
+
+        m_Ptr = nullptr;
+        m_RefCount = nullptr;
+    }
+
+    void _IncWeakRef() noexcept
+    {
+        if (m_RefCount)
+            (void)m_RefCount->IncWeakRef();
+    }
+
+    void _DecWeakRef() noexcept
+    {
+        if (m_RefCount)
+        {
+            m_RefCount->ReleaseWeak();
+            m_RefCount = nullptr;
+        }
+    }
+
+    template<typename _Ty2>
+    static constexpr void _AssertSameRefCount() noexcept
+    {
+        static_assert(std::is_same_v<_RefCountType<_Ty>, _RefCountType<_Ty2>>, "EnableWeakRefs must agree between the source and destination types of a Ref conversion. Ref<void> keeps weak references enabled, so it cannot hold an object whose type opted out of them.");
+    }
+
+    template<typename _Ty2>
+    constexpr void _ConstructFromRaw(_Ty2* ptr) noexcept
+    {
+        static_assert(!std::is_void_v<_Ty2>, "A Ref cannot take ownership of a void pointer, the type of the object must be known to destroy it");
+
+        if constexpr (_HasRefFromThisV<_Ty2>)
+        {
+            // An object that is already owned shares its existing control block rather than getting a second one
+            if (ptr)
+            {
+                _ConstructFromWeak(static_cast<const EnableRefFromThis<typename _Ty2::_RefFromThisType>*>(ptr)->m_WeakThis);
+                if (m_RefCount)
+                {
+                    m_Ptr = static_cast<_Ty*>(ptr);
+                    return;
+                }
+            }
+        }
+
+        // The control block deletes the object as _Ty2, so _Ty needs no virtual destructor. It is the same block whatever the
+        // cv-qualifiers of _Ty2, which lets Ref::Release() recognize it.
+        using _Owned = std::remove_cv_t<_Ty2>;
+        m_Ptr = static_cast<_Ty*>(ptr);
+        m_RefCount = m_Ptr ? new _RefCountPtr<_Owned, _RefCountType<_Ty>>(const_cast<_Owned*>(ptr)) : nullptr;
+
+        if constexpr (_HasRefFromThisV<_Ty2>)
+        {
+            if (ptr)
+                _HookRefFromThis(ptr);
+        }
+    }
+
+    template<typename _Ty2>
+    constexpr void _MoveConstructFrom(_RefBase<_Ty2>&& ptr) noexcept
+    {
+        _AssertSameRefCount<_Ty2>();
+
+        m_Ptr = static_cast<_Ty*>(ptr.m_Ptr);
+        m_RefCount = ptr.m_RefCount;
+
+        ptr.m_Ptr = nullptr;
+        ptr.m_RefCount = nullptr;
+    }
+
+    template<typename _Ty2>
+    constexpr void _CopyConstructFrom(const Ref<_Ty2>& ref) noexcept
+    {
+        _AssertSameRefCount<_Ty2>();
+
+        m_Ptr = static_cast<_Ty*>(ref.m_Ptr);
+        m_RefCount = ref.m_RefCount;
+
+        _IncRef();
+    }
+
+    template<typename _Ty2>
+    constexpr void _WeaklyConstructFrom(const _RefBase<_Ty2>& ptr) noexcept
+    {
+        _AssertSameRefCount<_Ty2>();
+
+        m_Ptr = static_cast<_Ty*>(ptr.m_Ptr);
+        m_RefCount = ptr.m_RefCount;
+        _IncWeakRef();
+    }
+
+    // Shares the control block of owner while pointing at ptr
+    template<typename _Ty2>
+    constexpr void _AliasCopyFrom(const Ref<_Ty2>& owner, _Ty* ptr) noexcept
+    {
+        _AssertSameRefCount<_Ty2>();
+
+        m_Ptr = ptr;
+        m_RefCount = owner.m_RefCount;
+
+        _IncRef();
+    }
+
+    template<typename _Ty2>
+    constexpr void _AliasMoveFrom(_RefBase<_Ty2>&& owner, _Ty* ptr) noexcept
+    {
+        _AssertSameRefCount<_Ty2>();
+
+        m_Ptr = ptr;
+        m_RefCount = owner.m_RefCount;
+
+        owner.m_Ptr = nullptr;
+        owner.m_RefCount = nullptr;
+    }
+
+    template<typename _Ty2>
+    constexpr void _AliasWeaklyFrom(const _RefBase<_Ty2>& owner, _Ty* ptr) noexcept
+    {
+        _AssertSameRefCount<_Ty2>();
+
+        m_Ptr = ptr;
+        m_RefCount = owner.m_RefCount;
+
+        _IncWeakRef();
+    }
+
+    // Leaves this empty if the object has already expired
+    template<typename _Ty2>
+    constexpr void _ConstructFromWeak(const WeakRef<_Ty2>& weak) noexcept
+    {
+        _AssertSameRefCount<_Ty2>();
+
+        if (weak.m_RefCount && weak.m_RefCount->TryIncRef())
+        {
+            m_Ptr = static_cast<_Ty*>(weak.m_Ptr);
+            m_RefCount = weak.m_RefCount;
+        }
+    }
+
+    // Points the EnableRefFromThis base of ptr at this Ref's control block, unless another Ref already owns the object
+    template<typename _Ty2>
+    void _HookRefFromThis(_Ty2* ptr) noexcept
+    {
+        using _OwnerType = typename _Ty2::_RefFromThisType;
+        _AssertSameRefCount<_OwnerType>();
+
+        WeakRef<_OwnerType>& weakThis = static_cast<const EnableRefFromThis<_OwnerType>*>(ptr)->m_WeakThis;
+        if (weakThis.Expired())
+        {
+            weakThis.Reset();
+            weakThis.m_Ptr = static_cast<_OwnerType*>(ptr);
+            weakThis.m_RefCount = m_RefCount;
+            weakThis._IncWeakRef();
+        }
+    }
+
+private:
+    _Ty* m_Ptr = nullptr;
+    _RefCountType<_Ty>* m_RefCount = nullptr;
+
+private:
+    template<typename _Ty2>
+    friend class _RefBase;
+
+    friend class Ref<_Ty>;
+    friend class WeakRef<_Ty>;
+    friend struct _RefAccess;
+};
+
+template<typename _Ty>
+class Ref : public _RefBase<_Ty>
+{
+public:
+    constexpr explicit Ref(_Ty* ptr) noexcept { this->_ConstructFromRaw(ptr); }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr explicit Ref(_Ty2* ptr) noexcept { this->_ConstructFromRaw(ptr); }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr Ref(const Ref<_Ty2>& other) noexcept { this->_CopyConstructFrom(other); }
+
+    Ref(const Ref<_Ty>& other) noexcept : _RefBase<_Ty>() { this->_CopyConstructFrom(other); }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr Ref(Ref<_Ty2>&& other) noexcept { this->_MoveConstructFrom(std::move(other)); }
+
+    constexpr Ref(Ref<_Ty>&& other) noexcept { this->_MoveConstructFrom(std::move(other)); }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr explicit Ref(const WeakRef<_Ty2>& weak) noexcept { this->_ConstructFromWeak(weak); }
+
+    constexpr explicit Ref(const WeakRef<_Ty>& weak) noexcept { this->_ConstructFromWeak(weak); }
+
+    // Aliasing constructors: share the control block of owner while pointing at ptr, typically a sub-object of owner.
+    // The object owned by owner is the one destroyed once the last reference to either is released.
+    template<typename _Ty2>
+    constexpr Ref(const Ref<_Ty2>& owner, _Ty* ptr) noexcept { this->_AliasCopyFrom(owner, ptr); }
+
+    template<typename _Ty2>
+    constexpr Ref(Ref<_Ty2>&& owner, _Ty* ptr) noexcept { this->_AliasMoveFrom(std::move(owner), ptr); }
+
+    constexpr Ref(std::nullptr_t) noexcept : _RefBase<_Ty>(nullptr) { };
+    constexpr Ref() noexcept = default;
+    constexpr ~Ref() noexcept { this->_DecRef(); }
+
+    constexpr void Swap(Ref<_Ty>& other) noexcept
+    {
+        if (this != &other)
+            this->_Swap(other);
+    }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr void Reset(_Ty2* newPtr) noexcept
+    {
+        Ref<_Ty>(newPtr).Swap(*this);
+    }
+
+    constexpr void Reset(_Ty* newPtr) noexcept
+    {
+        Ref<_Ty>(newPtr).Swap(*this);
+    }
+
+    constexpr void Reset() noexcept
+    {
+        Ref<_Ty>(nullptr).Swap(*this);
+    }
+
+    // Gives up this reference without destroying the object and returns it for the caller to delete.
+    // Only a Ref of the type the object was created as, pointing at the object itself, can hand over an object allocated on its
+    // own with new. Deleting anything else would be wrong, so this returns nullptr and the Ref keeps its reference for objects
+    // from CreateRefs, MappedFile or RefBuffer, for Refs to a base class or sub-object, and for Refs converted to another type.
+    constexpr _Ty* Release() noexcept
+    {
+        if (!_CanRelease())
+            return nullptr;
+
+        _Ty* res = this->m_Ptr;
+        this->_Abandon();
+
+        return res;
+    }
+
+    uint32_t RefCount() const noexcept
+    {
+        return this->_RefCount();
+    }
+
+    bool Unique() const noexcept
+    {
+        return RefCount() == 1;
+    }
+
+    constexpr _Ty* Raw() const noexcept
+    {
+        return this->_Raw();
+    }
+
+    constexpr bool Valid() const noexcept
+    {
+        return Raw() != nullptr;
+    }
+
+    constexpr explicit operator bool() const noexcept { return Valid(); }
+
+    Ref<_Ty>& operator=(const Ref<_Ty>& other) noexcept
+    {
+        Ref<_Ty>(other).Swap(*this);
+        return *this;
+    }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr Ref<_Ty>& operator=(const Ref<_Ty2>& other) noexcept
+    {
+        Ref<_Ty>(other).Swap(*this);
+        return *this;
+    }
+
+    Ref<_Ty>& operator=(Ref<_Ty>&& other) noexcept
+    {
+        Ref<_Ty>(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr Ref<_Ty>& operator=(Ref<_Ty2>&& other) noexcept
+    {
+        Ref<_Ty>(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    constexpr Ref<_Ty>& operator=(std::nullptr_t) noexcept
+    {
+        Ref<_Ty>(nullptr).Swap(*this);
+        return *this;
+    }
+
+    constexpr _Ty* operator->() const noexcept { return this->Raw(); }
+    constexpr std::add_lvalue_reference_t<_Ty> operator*() const noexcept { return *Raw(); }
+
+private:
+    // Adopts a control block whose strong count already accounts for this reference
+    constexpr Ref(_Ty* ptr, _RefCountType<_Ty>* refCount) noexcept
+    {
+        this->m_Ptr = ptr;
+        this->m_RefCount = refCount;
+    }
+
+    bool _CanRelease() const noexcept
+    {
+        if constexpr (std::is_void_v<_Ty>)
+            return !this->m_RefCount;
+        else
+            return !this->m_RefCount || _RefCountPtr<std::remove_cv_t<_Ty>, _RefCountType<_Ty>>::Owns(this->m_RefCount, this->m_Ptr);
+    }
+
+private:
+    template<typename _Ty2>
+    friend class Ref;
+
+    friend struct _RefAccess;
+};
+
+// Gives the library's factories access to the adopting constructor of Ref
+struct _RefAccess
+{
+    template<typename _Ty>
+    static constexpr Ref<_Ty> Adopt(_Ty* ptr, _RefCountType<_Ty>* refCount) noexcept
+    {
+        return Ref<_Ty>(ptr, refCount);
+    }
+
+    template<typename _Ty>
+    static constexpr _RefCountType<_Ty>* GetRefCount(const _RefBase<_Ty>& ref) noexcept
+    {
+        return ref.m_RefCount;
+    }
+
+    template<typename _Ty>
+    static void HookRefFromThis(Ref<_Ty>& ref) noexcept
+    {
+        if constexpr (_HasRefFromThisV<_Ty>)
+            ref._HookRefFromThis(ref.m_Ptr);
+    }
+
+    // Empties ref without touching the reference count it held
+    template<typename _Ty>
+    static constexpr void Detach(_RefBase<_Ty>& ref) noexcept
+    {
+        ref.m_Ptr = nullptr;
+        ref.m_RefCount = nullptr;
+    }
+};
+
+template<typename _Ty, typename... _Args, std::enable_if_t<std::negation_v<std::is_array<_Ty>>, int> = 0>
+constexpr static Ref<_Ty> CreateRef(_Args&&... args) noexcept
+{
+    return Ref<_Ty>(new _Ty(std::forward<_Args>(args)...));
+}
+
+// Specialize this trait to std::true_type to have CreateRefs always allocate the objects apart from their control blocks.
+// The objects are then freed as soon as the last of them is destroyed, while WeakRefs only keep the small control blocks alive.
+// Batches whose objects take up at least _SplitPayloadBytes are split regardless of this trait.
+template<typename _Ty>
+struct SplitRefPayload : std::false_type { };
+
+inline constexpr size_t _SplitPayloadBytes = 64 * 1024;
+
+// The allocation holding the control blocks and objects created by CreateRefs.
+// The header is followed by every control block and then by every object, each stored contiguously. When the batch is split, the
+// objects live in a second allocation that is freed once every object is destroyed, leaving the control blocks as tombstones
+// for the WeakRefs that remain.
+template<typename _Ty>
+class _RefBatch
+{
+private:
+    class _Block : public _RefCountType<_Ty>
+    {
+    public:
+        constexpr explicit _Block(_RefBatch* batch) noexcept : _RefCountType<_Ty>(&s_Ops), m_Batch(batch) { };
+
+    private:
+        static void _Destroy(_AtomicStrongRefCount* refCount) noexcept
+        {
+            _Block* block = static_cast<_Block*>(refCount);
+            block->m_Batch->_ObjectOf(block)->~_Ty();
+            block->m_Batch->_ReleaseObject();
+        }
+
+        static void _Free(_AtomicStrongRefCount* refCount) noexcept
+        {
+            _Block* block = static_cast<_Block*>(refCount);
+            _RefBatch* batch = block->m_Batch;
+
+            block->~_Block();
+            batch->_ReleaseBlock();
+        }
+
+        static void* _GetObject(const _AtomicStrongRefCount* refCount) noexcept
+        {
+            _Block* block = const_cast<_Block*>(static_cast<const _Block*>(refCount));
+            return const_cast<std::remove_cv_t<_Ty>*>(block->m_Batch->_ObjectOf(block));
+        }
+
+    private:
+        static constexpr _RefCountOps s_Ops{ &_Destroy, &_Free, &_GetObject, _DeferRefDestructionV<_Ty> };
+
+        _RefBatch* m_Batch;
+    };
+
+public:
+    template<typename... _Args>
+    static std::vector<Ref<_Ty>> Create(size_t count, const _Args&... args) noexcept
+    {
+        std::vector<Ref<_Ty>> res;
+        if (count == 0)
+            return res;
+
+        res.reserve(count);
+
+        // Without weak references the control blocks are released together with the objects, so there is nothing to split
+        const bool split = _EnableWeakRefsV<_Ty> && (SplitRefPayload<std::remove_cv_t<_Ty>>::value || ((count * sizeof(_Ty)) >= _SplitPayloadBytes));
+
+        size_t objectsOffset = _AlignUp(_BlocksOffset() + (count * sizeof(_Block)), alignof(_Ty));
+        void* storage = ::operator new(split ? objectsOffset : (objectsOffset + (count * sizeof(_Ty))), std::align_val_t(_Alignment()));
+        std::byte* objects = split ? static_cast<std::byte*>(::operator new(count * sizeof(_Ty), std::align_val_t(alignof(_Ty))))
+                                   : (static_cast<std::byte*>(storage) + objectsOffset);
+
+        _RefBatch* batch = ::new (storage) _RefBatch(count, objects, split);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            _Block* block = ::new (batch->_Blocks() + i) _Block(batch);
+            _Ty* obj = ::new (static_cast<void*>(batch->_Objects() + i)) _Ty(args...);
+
+            res.push_back(_RefAccess::Adopt(obj, static_cast<_RefCountType<_Ty>*>(block)));
+            _RefAccess::HookRefFromThis(res.back());
+        }
+
+        return res;
+    }
+
+private:
+    constexpr _RefBatch(size_t count, std::byte* objects, bool split) noexcept : m_LiveBlocks(count), m_LiveObjects(count), m_Objects(objects), m_Split(split) { };
+
+    static constexpr size_t _AlignUp(size_t offset, size_t alignment) noexcept
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    static constexpr size_t _BlocksOffset() noexcept
+    {
+        return _AlignUp(sizeof(_RefBatch), alignof(_Block));
+    }
+
+    static constexpr size_t _Alignment() noexcept
+    {
+        return std::max({ alignof(_RefBatch), alignof(_Block), alignof(_Ty) });
+    }
+
+    _Block* _Blocks() noexcept
+    {
+        return reinterpret_cast<_Block*>(reinterpret_cast<std::byte*>(this) + _BlocksOffset());
+    }
+
+    _Ty* _Objects() noexcept
+    {
+        return reinterpret_cast<_Ty*>(m_Objects);
+    }
+
+    _Ty* _ObjectOf(_Block* block) noexcept
+    {
+        return _Objects() + (block - _Blocks());
+    }
+
+    void _ReleaseObject() noexcept
+    {
+        if (m_Split && (m_LiveObjects.fetch_sub(1, std::memory_order_acq_rel) == 1))
+            ::operator delete(static_cast<void*>(m_Objects), std::align_val_t(alignof(_Ty)));
+    }
+
+    void _ReleaseBlock() noexcept
+    {
+        if (m_LiveBlocks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            // Every object has been destroyed by now since Ref::Release() refuses batch objects, but a split payload
+            // whose count was never brought to zero must still not outlive the batch that points to it
+            if (m_Split && (m_LiveObjects.load(std::memory_order_acquire) != 0))
+                ::operator delete(static_cast<void*>(m_Objects), std::align_val_t(alignof(_Ty)));
+
+            this->~_RefBatch();
+            ::operator delete(static_cast<void*>(this), std::align_val_t(_Alignment()));
+        }
+    }
+
+private:
+    std::atomic_size_t m_LiveBlocks;
+    std::atomic_size_t m_LiveObjects;
+    std::byte* m_Objects;
+    bool m_Split;
+};
+
+// Creates count objects, each constructed from args, in one allocation shared with their control blocks.
+// Each returned Ref is independent, the allocation is released once every object and WeakRef to it is gone.
+// Large batches and types opting into SplitRefPayload free their objects once the last one is destroyed instead.
+// Ownership of these objects cannot be taken over through Ref::Release(), which returns nullptr for them.
+template<typename _Ty, typename... _Args, std::enable_if_t<std::negation_v<std::is_array<_Ty>>, int> = 0>
+static std::vector<Ref<_Ty>> CreateRefs(size_t count, const _Args&... args) noexcept
+{
+    return _RefBatch<_Ty>::Create(count, args...);
+}
+
+template<typename _WantedType, typename _RefType>
+constexpr static _WantedType* GetRefBaseTypePtr(const Ref<_RefType>& ref) noexcept
+{
+    return static_cast<_WantedType*>(ref.Raw());
+}
+
+// The Ref casts share the control block of the source, which still destroys the object as the type it was created as.
+// The rvalue overloads take over the reference of the source without touching the reference count.
+template<typename _Ty, typename _Ty2>
+constexpr static Ref<_Ty> StaticRefCast(const Ref<_Ty2>& ref) noexcept
+{
+    return Ref<_Ty>(ref, static_cast<_Ty*>(ref.Raw()));
+}
+
+template<typename _Ty, typename _Ty2>
+constexpr static Ref<_Ty> StaticRefCast(Ref<_Ty2>&& ref) noexcept
+{
+    _Ty* ptr = static_cast<_Ty*>(ref.Raw());
+    return Ref<_Ty>(std::move(ref), ptr);
+}
+
+// Returns nullptr, leaving ref untouched, if the object is not a _Ty
+template<typename _Ty, typename _Ty2>
+constexpr static Ref<_Ty> DynamicRefCast(const Ref<_Ty2>& ref) noexcept
+{
+    _Ty* ptr = dynamic_cast<_Ty*>(ref.Raw());
+    return ptr ? Ref<_Ty>(ref, ptr) : nullptr;
+}
+
+template<typename _Ty, typename _Ty2>
+constexpr static Ref<_Ty> DynamicRefCast(Ref<_Ty2>&& ref) noexcept
+{
+    _Ty* ptr = dynamic_cast<_Ty*>(ref.Raw());
+    return ptr ? Ref<_Ty>(std::move(ref), ptr) : nullptr;
+}
+
+template<typename _Ty, typename _Ty2>
+constexpr static Ref<_Ty> ConstRefCast(const Ref<_Ty2>& ref) noexcept
+{
+    return Ref<_Ty>(ref, const_cast<_Ty*>(ref.Raw()));
+}
+
+template<typename _Ty, typename _Ty2>
+constexpr static Ref<_Ty> ConstRefCast(Ref<_Ty2>&& ref) noexcept
+{
+    _Ty* ptr = const_cast<_Ty*>(ref.Raw());
+    return Ref<_Ty>(std::move(ref), ptr);
+}
+
+template<typename _Ty>
+class WeakRef : public _RefBase<_Ty>
+{
+public:
+    constexpr WeakRef(const Ref<_Ty>& ref) noexcept { this->_WeaklyConstructFrom(ref); }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr WeakRef(const Ref<_Ty2>& ref) noexcept { this->_WeaklyConstructFrom(ref); }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr WeakRef(const WeakRef<_Ty2>& other) noexcept { this->_WeaklyConstructFrom(other); }
+
+    constexpr WeakRef(const WeakRef<_Ty>& other) noexcept : _RefBase<_Ty>() { this->_WeaklyConstructFrom(other); }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr WeakRef(WeakRef<_Ty2>&& other) noexcept { this->_MoveConstructFrom(std::move(other)); }
+
+    constexpr WeakRef(WeakRef<_Ty>&& other) noexcept { this->_MoveConstructFrom(std::move(other)); }
+
+    // Aliasing constructors: observe the object owned by owner while pointing at ptr, typically a sub-object of owner
+    template<typename _Ty2>
+    constexpr WeakRef(const Ref<_Ty2>& owner, _Ty* ptr) noexcept { this->_AliasWeaklyFrom(owner, ptr); }
+
+    template<typename _Ty2>
+    constexpr WeakRef(const WeakRef<_Ty2>& owner, _Ty* ptr) noexcept { this->_AliasWeaklyFrom(owner, ptr); }
+
+    template<typename _Ty2>
+    constexpr WeakRef(WeakRef<_Ty2>&& owner, _Ty* ptr) noexcept { this->_AliasMoveFrom(std::move(owner), ptr); }
+
+    constexpr WeakRef(std::nullptr_t) noexcept : _RefBase<_Ty>(nullptr) { };
+    constexpr WeakRef() noexcept = default;
+    constexpr ~WeakRef() noexcept
+    {
+        // Asserted here rather than in the class body since Ref's overload set names WeakRef<_Ty> for every type
+        static_assert(_EnableWeakRefsV<_Ty>, "WeakRef cannot be used with a type whose EnableWeakRefs trait is false");
+        this->_DecWeakRef();
+    }
+
+    constexpr void Swap(WeakRef<_Ty>& other) noexcept
+    {
+        if (this != &other)
+            this->_Swap(other);
+    }
+
+    constexpr void Reset() noexcept
+    {
+        WeakRef<_Ty>(nullptr).Swap(*this);
+    }
+
+    uint32_t RefCount() const noexcept
+    {
+        return this->_RefCount();
+    }
+
+    bool Unique() const noexcept
+    {
+        return RefCount() == 1;
+    }
+
+    bool Expired() const noexcept
+    {
+        return RefCount() == 0;
+    }
+
+    constexpr _Ty* Raw() const noexcept
+    {
+        return this->_Raw();
+    }
+
+    constexpr bool Valid() const noexcept
+    {
+        return Raw() != nullptr;
+    }
+
+    Ref<_Ty> Lock() const noexcept
+    {
+        Ref<_Ty> res;
+        res._ConstructFromWeak(*this);
+
+        return res;
+    }
+
+    constexpr explicit operator bool() const noexcept { return Valid(); }
+
+    WeakRef<_Ty>& operator=(const WeakRef<_Ty>& other) noexcept
+    {
+        WeakRef<_Ty>(other).Swap(*this);
+        return *this;
+    }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr WeakRef<_Ty>& operator=(const WeakRef<_Ty2>& other) noexcept
+    {
+        WeakRef<_Ty>(other).Swap(*this);
+        return *this;
+    }
+
+    WeakRef<_Ty>& operator=(WeakRef<_Ty>&& other) noexcept
+    {
+        WeakRef<_Ty>(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr WeakRef<_Ty>& operator=(WeakRef<_Ty2>&& other) noexcept
+    {
+        WeakRef<_Ty>(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    WeakRef<_Ty>& operator=(const Ref<_Ty>& ref) noexcept
+    {
+        WeakRef<_Ty>(ref).Swap(*this);
+        return *this;
+    }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    constexpr WeakRef<_Ty>& operator=(const Ref<_Ty2>& ref) noexcept
+    {
+        WeakRef<_Ty>(ref).Swap(*this);
+        return *this;
+    }
+
+    constexpr WeakRef<_Ty>& operator=(std::nullptr_t) noexcept
+    {
+        WeakRef<_Ty>(nullptr).Swap(*this);
+        return *this;
+    }
+
+private:
+    template<typename _Ty2>
+    friend class WeakRef;
+};
+
+// How many elements ahead the bulk operations prefetch control blocks
+inline constexpr size_t _BulkPrefetchDistance = 16;
+
+// Collects control blocks whose strong count reached zero during a bulk release and releases them grouped by type
+template<typename _Ty>
+class _BulkReleaser
+{
+public:
+    constexpr _BulkReleaser() noexcept = default;
+
+    ~_BulkReleaser() noexcept
+    {
+        Flush();
+    }
+
+    _BulkReleaser(const _BulkReleaser&) = delete;
+    _BulkReleaser& operator=(const _BulkReleaser&) = delete;
+
+    void Add(_RefCountType<_Ty>* refCount) noexcept
+    {
+        m_Pending[m_Size++] = refCount;
+        if (m_Size == s_Capacity)
+            Flush();
+    }
+
+    void Flush() noexcept
+    {
+        // Control blocks sharing an ops table destroy the same concrete type through the same functions
+        std::sort(m_Pending, m_Pending + m_Size, [](const auto* left, const auto* right) { return left->GetOps() < right->GetOps(); });
+
+        for (size_t i = 0; i < m_Size; ++i)
+        {
+            _ReleaseOrDefer(m_Pending[i]);
+        }
+
+        m_Size = 0;
+    }
+
+private:
+    static constexpr size_t s_Capacity = 64;
+
+    _RefCountType<_Ty>* m_Pending[s_Capacity];
+    size_t m_Size = 0;
+};
+
+// Increments the control blocks returned by getRefCount(i) for i in [0, count), prefetching ahead of the increments.
+// Adjacent indices sharing a control block are combined into a single atomic add.
+template<typename _Ty, typename _GetRefCount>
+static void _RetainEach(size_t count, _GetRefCount&& getRefCount) noexcept
+{
+    _RefCountType<_Ty>* pending = nullptr;
+    uint32_t pendingCount = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if ((i + _BulkPrefetchDistance) < count)
+            _INTRICATE_PREFETCH(getRefCount(i + _BulkPrefetchDistance));
+
+        _RefCountType<_Ty>* refCount = getRefCount(i);
+        if (refCount == pending)
+        {
+            ++pendingCount;
+            continue;
+        }
+
+        if (pending)
+            (void)pending->IncRef(pendingCount);
+
+        pending = refCount;
+        pendingCount = 1;
+    }
+
+    if (pending)
+        (void)pending->IncRef(pendingCount);
+}
+
+// Decrements the control blocks returned by takeRefCount(i) for i in [0, count), prefetching ahead of the decrements.
+// Adjacent indices sharing a control block are combined into a single atomic subtract and the
+// objects whose count reached zero are destroyed in groups of the same type.
+// takeRefCount is called exactly once for each index, in order, after a prefetch of peekRefCount.
+template<typename _Ty, typename _PeekRefCount, typename _TakeRefCount>
+static void _ReleaseEach(size_t count, _PeekRefCount&& peekRefCount, _TakeRefCount&& takeRefCount) noexcept
+{
+    _BulkReleaser<_Ty> releaser;
+    _RefCountType<_Ty>* pending = nullptr;
+    uint32_t pendingCount = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if ((i + _BulkPrefetchDistance) < count)
+            _INTRICATE_PREFETCH(peekRefCount(i + _BulkPrefetchDistance));
+
+        _RefCountType<_Ty>* refCount = takeRefCount(i);
+        if (refCount == pending)
+        {
+            ++pendingCount;
+            continue;
+        }
+
+        if (pending && (pending->DecRef(pendingCount) == 0))
+            releaser.Add(pending);
+
+        pending = refCount;
+        pendingCount = 1;
+    }
+
+    if (pending && (pending->DecRef(pendingCount) == 0))
+        releaser.Add(pending);
+}
+
+// Increments the reference count of every Ref in refs, prefetching control blocks ahead of the increments.
+// Only adjacent Refs sharing a control block are combined into a single atomic add.
+// The counts retained here belong to no Ref, so each must be adopted by a new one, as CopyRefs() does, or it leaks.
+template<typename _Ty>
+static void _RetainAll(std::span<const Ref<_Ty>> refs) noexcept
+{
+    _RetainEach<_Ty>(refs.size(), [refs](size_t i) { return _RefAccess::GetRefCount(refs[i]); });
+}
+
+// Releases every Ref in refs and leaves them empty, prefetching control blocks ahead of the decrements.
+// Only adjacent Refs sharing a control block are combined into a single atomic subtract, duplicates further apart are
+// released one at a time. The objects whose count reached zero are destroyed in groups of the same type.
+template<typename _Ty>
+static void ReleaseAll(std::span<Ref<_Ty>> refs) noexcept
+{
+    _ReleaseEach<_Ty>(refs.size(), [refs](size_t i) { return _RefAccess::GetRefCount(refs[i]); }, [refs](size_t i)
+    {
+        _RefCountType<_Ty>* refCount = _RefAccess::GetRefCount(refs[i]);
+        _RefAccess::Detach(refs[i]);
+
+        return refCount;
+    });
+}
+
+template<typename _Ty>
+static void ReleaseAll(std::vector<Ref<_Ty>>& refs) noexcept
+{
+    ReleaseAll(std::span<Ref<_Ty>>(refs));
+}
+
+// Copies refs into a new vector using a single bulk retain, which combines only adjacent duplicates
+template<typename _Ty>
+static std::vector<Ref<_Ty>> CopyRefs(std::span<const Ref<_Ty>> refs) noexcept
+{
+    _RetainAll(refs);
+
+    std::vector<Ref<_Ty>> res;
+    res.reserve(refs.size());
+    for (const Ref<_Ty>& ref : refs)
+        res.push_back(_RefAccess::Adopt(ref.Raw(), _RefAccess::GetRefCount(ref)));
+
+    return res;
+}
+
+template<typename _Ty>
+static std::vector<Ref<_Ty>> CopyRefs(const std::vector<Ref<_Ty>>& refs) noexcept
+{
+    return CopyRefs(std::span<const Ref<_Ty>>(refs));
+}
+
+// Releases every element of refs using a single ReleaseAll() pass, then clears it
+template<typename _Ty>
+static void ClearRefs(std::vector<Ref<_Ty>>& refs) noexcept
+{
+    ReleaseAll(refs);
+    refs.clear();
+}
+
+// A container of Refs storing the object pointers and control blocks in separate arrays.
+// Iterating and indexing read only the object pointers, control blocks are touched only when references are added or released.
+template<typename _Ty>
+class RefArray
+{
+public:
+    using Iterator = _Ty* const*;
+
+    explicit RefArray(std::span<const Ref<_Ty>> refs) noexcept
+    {
+        m_Ptrs.reserve(refs.size());
+        m_RefCounts.reserve(refs.size());
+
+        for (const Ref<_Ty>& ref : refs)
+        {
+            m_Ptrs.push_back(ref.Raw());
+            m_RefCounts.push_back(_RefAccess::GetRefCount(ref));
+        }
+
+        _RetainEach<_Ty>(m_RefCounts.size(), [this](size_t i) { return m_RefCounts[i]; });
+    }
+
+    explicit RefArray(const std::vector<Ref<_Ty>>& refs) noexcept : RefArray(std::span<const Ref<_Ty>>(refs)) { };
+
+    RefArray(const RefArray<_Ty>& other) noexcept : m_Ptrs(other.m_Ptrs), m_RefCounts(other.m_RefCounts)
+    {
+        _RetainEach<_Ty>(m_RefCounts.size(), [this](size_t i) { return m_RefCounts[i]; });
+    }
+
+    RefArray(RefArray<_Ty>&& other) noexcept : m_Ptrs(std::move(other.m_Ptrs)), m_RefCounts(std::move(other.m_RefCounts)) { };
+    RefArray() noexcept = default;
+
+    ~RefArray() noexcept
+    {
+        Clear();
+    }
+
+    void Swap(RefArray<_Ty>& other) noexcept
+    {
+        m_Ptrs.swap(other.m_Ptrs);
+        m_RefCounts.swap(other.m_RefCounts);
+    }
+
+    void Reserve(size_t capacity) noexcept
+    {
+        m_Ptrs.reserve(capacity);
+        m_RefCounts.reserve(capacity);
+    }
+
+    void PushBack(const Ref<_Ty>& ref) noexcept
+    {
+        PushBack(Ref<_Ty>(ref));
+    }
+
+    void PushBack(Ref<_Ty>&& ref) noexcept
+    {
+        m_Ptrs.push_back(ref.Raw());
+        m_RefCounts.push_back(_RefAccess::GetRefCount(ref));
+        _RefAccess::Detach(ref);
+    }
+
+    template<typename... _Args>
+    _Ty* EmplaceBack(_Args&&... args) noexcept
+    {
+        PushBack(CreateRef<_Ty>(std::forward<_Args>(args)...));
+        return m_Ptrs.back();
+    }
+
+    // Returns a new reference to the element at index
+    Ref<_Ty> Get(size_t index) const noexcept
+    {
+        if (m_RefCounts[index])
+            (void)m_RefCounts[index]->IncRef();
+
+        return _RefAccess::Adopt(m_Ptrs[index], m_RefCounts[index]);
+    }
+
+    // Removes the last element and hands its reference to the caller
+    Ref<_Ty> PopBack() noexcept
+    {
+        Ref<_Ty> res = _RefAccess::Adopt(m_Ptrs.back(), m_RefCounts.back());
+        m_Ptrs.pop_back();
+        m_RefCounts.pop_back();
+
+        return res;
+    }
+
+    // Removes the element at index and hands its reference to the caller, preserving the order of the remaining elements
+    Ref<_Ty> Extract(size_t index) noexcept
+    {
+        Ref<_Ty> res = _RefAccess::Adopt(m_Ptrs[index], m_RefCounts[index]);
+        m_Ptrs.erase(m_Ptrs.begin() + index);
+        m_RefCounts.erase(m_RefCounts.begin() + index);
+
+        return res;
+    }
+
+    // Releases every element with a single bulk pass
+    void Clear() noexcept
+    {
+        _ReleaseEach<_Ty>(m_RefCounts.size(), [this](size_t i) { return m_RefCounts[i]; }, [this](size_t i) { return m_RefCounts[i]; });
+
+        m_Ptrs.clear();
+        m_RefCounts.clear();
+    }
+
+    // Copies every element into a vector of Refs with a single bulk retain
+    std::vector<Ref<_Ty>> ToVector() const noexcept
+    {
+        _RetainEach<_Ty>(m_RefCounts.size(), [this](size_t i) { return m_RefCounts[i]; });
+
+        std::vector<Ref<_Ty>> res;
+        res.reserve(Size());
+        for (size_t i = 0; i < Size(); ++i)
+            res.push_back(_RefAccess::Adopt(m_Ptrs[i], m_RefCounts[i]));
+
+        return res;
+    }
+
+    size_t Size() const noexcept
+    {
+        return m_Ptrs.size();
+    }
+
+    bool Empty() const noexcept
+    {
+        return m_Ptrs.empty();
+    }
+
+    _Ty* const* Data() const noexcept
+    {
+        return m_Ptrs.data();
+    }
+
+    Iterator begin() const noexcept { return m_Ptrs.data(); }
+    Iterator end() const noexcept { return m_Ptrs.data() + m_Ptrs.size(); }
+
+    RefArray<_Ty>& operator=(const RefArray<_Ty>& other) noexcept
+    {
+        RefArray<_Ty>(other).Swap(*this);
+        return *this;
+    }
+
+    RefArray<_Ty>& operator=(RefArray<_Ty>&& other) noexcept
+    {
+        RefArray<_Ty>(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    _Ty* operator[](size_t index) const noexcept { return m_Ptrs[index]; }
+
+private:
+    std::vector<_Ty*> m_Ptrs;
+    std::vector<_RefCountType<_Ty>*> m_RefCounts;
+};
+
+// Specialize this trait to std::true_type for types that can be moved to a new address with memcpy, leaving nothing to destroy
+// at the old one. Trivially copyable types are trivially relocatable, as are Scope, Ref and WeakRef since nothing points at them.
+template<typename _Ty>
+struct TriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<_Ty>> { };
+
+template<typename _Ty>
+struct TriviallyRelocatable<Scope<_Ty>> : std::true_type { };
+
+template<typename _Ty>
+struct TriviallyRelocatable<Ref<_Ty>> : std::true_type { };
+
+template<typename _Ty>
+struct TriviallyRelocatable<WeakRef<_Ty>> : std::true_type { };
+
+template<typename _Ty>
+constexpr bool _TriviallyRelocatableV = TriviallyRelocatable<std::remove_cv_t<_Ty>>::value;
+
+// A vector that grows trivially relocatable elements with realloc, moving them at memcpy speed without running any
+// move constructors or destructors. Other element types are moved one by one as std::vector would.
+template<typename _Ty>
+class RelocVector
+{
+public:
+    using Iterator = _Ty*;
+    using ConstIterator = const _Ty*;
+
+    explicit RelocVector(std::span<const _Ty> values) noexcept
+    {
+        Reserve(values.size());
+        std::uninitialized_copy(values.begin(), values.end(), m_Data);
+        m_Size = values.size();
+    }
+
+    RelocVector(const RelocVector<_Ty>& other) noexcept : RelocVector(std::span<const _Ty>(other.m_Data, other.m_Size)) { };
+
+    RelocVector(RelocVector<_Ty>&& other) noexcept
+        : m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0)), m_Capacity(std::exchange(other.m_Capacity, 0)) { };
+
+    RelocVector() noexcept = default;
+
+    ~RelocVector() noexcept
+    {
+        Clear();
+        _Deallocate(m_Data);
+    }
+
+    void Swap(RelocVector<_Ty>& other) noexcept
+    {
+        std::swap(m_Data, other.m_Data);
+        std::swap(m_Size, other.m_Size);
+        std::swap(m_Capacity, other.m_Capacity);
+    }
+
+    void Reserve(size_t capacity) noexcept
+    {
+        if (capacity > m_Capacity)
+            _Reallocate(capacity);
+    }
+
+    // Releases unused capacity
+    void ShrinkToFit() noexcept
+    {
+        if (m_Size < m_Capacity)
+            _Reallocate(m_Size);
+    }
+
+    template<typename... _Args>
+    _Ty& EmplaceBack(_Args&&... args) noexcept
+    {
+        if (m_Size == m_Capacity)
+        {
+            // The arguments may refer to an element, so construct the value before the storage moves
+            _Ty value(std::forward<_Args>(args)...);
+            _Reallocate(std::max<size_t>(m_Capacity * 2, 8));
+            return *new (m_Data + m_Size++) _Ty(std::move(value));
+        }
+
+        return *new (m_Data + m_Size++) _Ty(std::forward<_Args>(args)...);
+    }
+
+    void PushBack(const _Ty& value) noexcept
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(_Ty&& value) noexcept
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept
+    {
+        std::destroy_at(m_Data + --m_Size);
+    }
+
+    void Clear() noexcept
+    {
+        std::destroy(m_Data, m_Data + m_Size);
+        m_Size = 0;
+    }
+
+    size_t Size() const noexcept
+    {
+        return m_Size;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return m_Capacity;
+    }
+
+    bool Empty() const noexcept
+    {
+        return m_Size == 0;
+    }
+
+    _Ty* Data() noexcept { return m_Data; }
+    const _Ty* Data() const noexcept { return m_Data; }
+
+    _Ty& Back() noexcept { return m_Data[m_Size - 1]; }
+    const _Ty& Back() const noexcept { return m_Data[m_Size - 1]; }
+
+    Iterator begin() noexcept { return m_Data; }
+    Iterator end() noexcept { return m_Data + m_Size; }
+    ConstIterator begin() const noexcept { return m_Data; }
+    ConstIterator end() const noexcept { return m_Data + m_Size; }
+
+    RelocVector<_Ty>& operator=(const RelocVector<_Ty>& other) noexcept
+    {
+        RelocVector<_Ty>(other).Swap(*this);
+        return *this;
+    }
+
+    RelocVector<_Ty>& operator=(RelocVector<_Ty>&& other) noexcept
+    {
+        RelocVector<_Ty>(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    _Ty& operator[](size_t index) noexcept { return m_Data[index]; }
+    const _Ty& operator[](size_t index) const noexcept { return m_Data[index]; }
+
+private:
+    // realloc only guarantees fundamental alignment
+    static constexpr bool s_UseRealloc = _TriviallyRelocatableV<_Ty> && (alignof(_Ty) <= alignof(std::max_align_t));
+
+    void _Reallocate(size_t capacity) noexcept
+    {
+        if constexpr (s_UseRealloc)
+        {
+            if (capacity == 0)
+            {
+                std::free(std::exchange(m_Data, nullptr));
+            }
+            else
+            {
+                void* data = std::realloc(static_cast<void*>(m_Data), capacity * sizeof(_Ty));
+                if (!data)
+                    std::terminate();
+
+                m_Data = static_cast<_Ty*>(data);
+            }
+        }
+        else
+        {
+            _Ty* data = capacity ? static_cast<_Ty*>(::operator new(capacity * sizeof(_Ty), std::align_val_t(alignof(_Ty)))) : nullptr;
+            std::uninitialized_move(m_Data, m_Data + m_Size, data);
+            std::destroy(m_Data, m_Data + m_Size);
+            _Deallocate(std::exchange(m_Data, data));
+        }
+
+        m_Capacity = capacity;
+    }
+
+    static void _Deallocate(_Ty* data) noexcept
+    {
+        if constexpr (s_UseRealloc)
+            std::free(static_cast<void*>(data));
+        else if (data)
+            ::operator delete(static_cast<void*>(data), std::align_val_t(alignof(_Ty)));
+    }
+
+private:
+    _Ty* m_Data = nullptr;
+    size_t m_Size = 0;
+    size_t m_Capacity = 0;
+};
+
+// Mixes every bit of a pointer into the result. Objects are at least 8 or 16 byte aligned, so an identity hash leaves the low bits
+// zero and crowds power-of-two tables into a fraction of their buckets. std::hash<Ref> keeps std::hash<_Ty*>, since standard
+// libraries whose pointer hash is the identity pair it with prime bucket counts, where it is both well spread and cheaper.
+inline size_t _HashPointer(const void* ptr) noexcept
+{
+    uint64_t x = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+
+    return static_cast<size_t>(x);
+}
+
+// Open-addressing table keyed on the object pointers of Refs, shared by RefHashSet and RefHashMap.
+// Probing uses linear probing over an array holding nothing but the object pointers, while the control blocks and values are kept
+// in parallel arrays that are only touched once a key matches. Erasing shifts the following entries back, so there are no tombstones.
+template<typename _Ty, typename _Value>
+class _RefHashTable
+{
+protected:
+    static constexpr bool s_HasValues = !std::is_void_v<_Value>;
+    using _ValueType = std::conditional_t<s_HasValues, _Value, char>;
+    static constexpr size_t s_NotFound = SIZE_MAX;
+
+protected:
+    _RefHashTable(const _RefHashTable& other) noexcept
+    {
+        _Allocate(other.m_Capacity);
+        m_Size = other.m_Size;
+
+        for (size_t i = 0; i < m_Capacity; ++i)
+        {
+            m_Keys[i] = other.m_Keys[i];
+            m_RefCounts[i] = other.m_RefCounts[i];
+
+            if constexpr (s_HasValues)
+            {
+                if (m_Keys[i])
+                    new (m_Values + i) _ValueType(other.m_Values[i]);
+            }
+        }
+
+        _RetainEach<_Ty>(m_Capacity, [this](size_t i) { return m_RefCounts[i]; });
+    }
+
+    _RefHashTable(_RefHashTable&& other) noexcept
+        : m_Keys(std::exchange(other.m_Keys, nullptr)), m_RefCounts(std::exchange(other.m_RefCounts, nullptr)), m_Values(std::exchange(other.m_Values, nullptr)),
+          m_Size(std::exchange(other.m_Size, 0)), m_Capacity(std::exchange(other.m_Capacity, 0)) { };
+
+    _RefHashTable() noexcept = default;
+
+    ~_RefHashTable() noexcept
+    {
+        Clear();
+        _Deallocate();
+    }
+
+    size_t _Find(const _Ty* key) const noexcept
+    {
+        if (!m_Size || !key)
+            return s_NotFound;
+
+        const size_t mask = m_Capacity - 1;
+        for (size_t i = _HashPointer(key) & mask; m_Keys[i]; i = (i + 1) & mask)
+        {
+            if (m_Keys[i] == key)
+                return i;
+        }
+
+        return s_NotFound;
+    }
+
+    // Returns the slot of key and whether it was free, in which case the caller must fill it with _Place
+    std::pair<size_t, bool> _FindOrReserve(const _Ty* key) noexcept
+    {
+        // Probe before growing, so a key that is already present never causes a rehash
+        size_t slot = s_NotFound;
+        if (m_Capacity)
+        {
+            const size_t mask = m_Capacity - 1;
+            for (slot = _HashPointer(key) & mask; m_Keys[slot]; slot = (slot + 1) & mask)
+            {
+                if (m_Keys[slot] == key)
+                    return { slot, false };
+            }
+        }
+
+        // Keep the load factor at or below 3/4
+        if ((m_Size + 1) * 4 > m_Capacity * 3)
+        {
+            _Rehash(std::max<size_t>(m_Capacity * 2, 16));
+
+            const size_t mask = m_Capacity - 1;
+            for (slot = _HashPointer(key) & mask; m_Keys[slot]; slot = (slot + 1) & mask) { }
+        }
+
+        return { slot, true };
+    }
+
+    // Takes over the reference held by ref
+    template<typename... _Args>
+    void _Place(size_t slot, Ref<_Ty>&& ref, _Args&&... args) noexcept
+    {
+        if constexpr (s_HasValues)
+            new (m_Values + slot) _ValueType(std::forward<_Args>(args)...);
+
+        m_Keys[slot] = ref.Raw();
+        m_RefCounts[slot] = _RefAccess::GetRefCount(ref);
+        _RefAccess::Detach(ref);
+        ++m_Size;
+    }
+
+    // Empties slot and hands its reference to the caller
+    Ref<_Ty> _Remove(size_t slot) noexcept
+    {
+        Ref<_Ty> res = _RefAccess::Adopt(m_Keys[slot], m_RefCounts[slot]);
+        if constexpr (s_HasValues)
+            std::destroy_at(m_Values + slot);
+
+        // Shift back every following entry of the cluster that may not be reached from its home slot once slot is empty
+        const size_t mask = m_Capacity - 1;
+        size_t hole = slot;
+        for (size_t i = (slot + 1) & mask; m_Keys[i]; i = (i + 1) & mask)
+        {
+            const size_t home = _HashPointer(m_Keys[i]) & mask;
+            if (((i - home) & mask) < ((i - hole) & mask))
+                continue;
+
+            _Relocate(i, hole);
+            hole = i;
+        }
+
+        m_Keys[hole] = nullptr;
+        m_RefCounts[hole] = nullptr;
+        --m_Size;
+
+        return res;
+    }
+
+public:
+    void Reserve(size_t count) noexcept
+    {
+        size_t capacity = 16;
+        while (capacity * 3 < count * 4)
+            capacity *= 2;
+
+        if (capacity > m_Capacity)
+            _Rehash(capacity);
+    }
+
+    bool Contains(const _Ty* key) const noexcept
+    {
+        return _Find(key) != s_NotFound;
+    }
+
+    bool Erase(const _Ty* key) noexcept
+    {
+        const size_t slot = _Find(key);
+        if (slot == s_NotFound)
+            return false;
+
+        _Remove(slot);
+        return true;
+    }
+
+    // Releases every element with a single bulk pass
+    void Clear() noexcept
+    {
+        if (!m_Size)
+            return;
+
+        if constexpr (s_HasValues)
+        {
+            for (size_t i = 0; i < m_Capacity; ++i)
+            {
+                if (m_Keys[i])
+                    std::destroy_at(m_Values + i);
+            }
+        }
+
+        _ReleaseEach<_Ty>(m_Capacity, [this](size_t i) { return m_RefCounts[i]; }, [this](size_t i) { return std::exchange(m_RefCounts[i], nullptr); });
+        std::fill_n(m_Keys, m_Capacity, nullptr);
+        m_Size = 0;
+    }
+
+    size_t Size() const noexcept
+    {
+        return m_Size;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return m_Capacity;
+    }
+
+    bool Empty() const noexcept
+    {
+        return m_Size == 0;
+    }
+
+protected:
+    void _Relocate(size_t from, size_t to) noexcept
+    {
+        m_Keys[to] = m_Keys[from];
+        m_RefCounts[to] = m_RefCounts[from];
+
+        if constexpr (s_HasValues)
+        {
+            new (m_Values + to) _ValueType(std::move(m_Values[from]));
+            std::destroy_at(m_Values + from);
+        }
+    }
+
+    void _Rehash(size_t capacity) noexcept
+    {
+        _Ty** keys = m_Keys;
+        _RefCountType<_Ty>** refCounts = m_RefCounts;
+        _ValueType* values = m_Values;
+        const size_t oldCapacity = m_Capacity;
+
+        _Allocate(capacity);
+
+        const size_t mask = m_Capacity - 1;
+        for (size_t i = 0; i < oldCapacity; ++i)
+        {
+            if (!keys[i])
+                continue;
+
+            size_t slot = _HashPointer(keys[i]) & mask;
+            while (m_Keys[slot])
+                slot = (slot + 1) & mask;
+
+            m_Keys[slot] = keys[i];
+            m_RefCounts[slot] = refCounts[i];
+
+            if constexpr (s_HasValues)
+            {
+                new (m_Values + slot) _ValueType(std::move(values[i]));
+                std::destroy_at(values + i);
+            }
+        }
+
+        _Deallocate(keys, refCounts, values);
+    }
+
+    void _Allocate(size_t capacity) noexcept
+    {
+        m_Capacity = capacity;
+        m_Keys = capacity ? new _Ty*[capacity]() : nullptr;
+        m_RefCounts = capacity ? new _RefCountType<_Ty>*[capacity]() : nullptr;
+
+        if constexpr (s_HasValues)
+            m_Values = capacity ? static_cast<_ValueType*>(::operator new(capacity * sizeof(_ValueType), std::align_val_t(alignof(_ValueType)))) : nullptr;
+    }
+
+    void _Deallocate() noexcept
+    {
+        _Deallocate(m_Keys, m_RefCounts, m_Values);
+    }
+
+    static void _Deallocate(_Ty** keys, _RefCountType<_Ty>** refCounts, _ValueType* values) noexcept
+    {
+        delete[] keys;
+        delete[] refCounts;
+
+        if constexpr (s_HasValues)
+        {
+            if (values)
+                ::operator delete(static_cast<void*>(values), std::align_val_t(alignof(_ValueType)));
+        }
+    }
+
+    void _Swap(_RefHashTable& other) noexcept
+    {
+        std::swap(m_Keys, other.m_Keys);
+        std::swap(m_RefCounts, other.m_RefCounts);
+        std::swap(m_Values, other.m_Values);
+        std::swap(m_Size, other.m_Size);
+        std::swap(m_Capacity, other.m_Capacity);
+    }
+
+protected:
+    _Ty** m_Keys = nullptr;
+    _RefCountType<_Ty>** m_RefCounts = nullptr;
+    _ValueType* m_Values = nullptr;
+    size_t m_Size = 0;
+    size_t m_Capacity = 0;
+};
+
+// A hash set of Refs that compares them by object pointer. Lookups take raw pointers and never touch a reference count.
+template<typename _Ty>
+class RefHashSet : public _RefHashTable<_Ty, void>
+{
+public:
+    RefHashSet(const RefHashSet<_Ty>& other) noexcept : _RefHashTable<_Ty, void>(other) { };
+    RefHashSet(RefHashSet<_Ty>&& other) noexcept : _RefHashTable<_Ty, void>(std::move(other)) { };
+    RefHashSet() noexcept = default;
+
+    void Swap(RefHashSet<_Ty>& other) noexcept
+    {
+        this->_Swap(other);
+    }
+
+    // Returns false if the object was already in the set or ref is empty
+    bool Insert(const Ref<_Ty>& ref) noexcept
+    {
+        auto [slot, inserted] = ref ? this->_FindOrReserve(ref.Raw()) : std::pair<size_t, bool>(0, false);
+        if (inserted)
+            this->_Place(slot, Ref<_Ty>(ref));
+
+        return inserted;
+    }
+
+    bool Insert(Ref<_Ty>&& ref) noexcept
+    {
+        auto [slot, inserted] = ref ? this->_FindOrReserve(ref.Raw()) : std::pair<size_t, bool>(0, false);
+        if (inserted)
+            this->_Place(slot, std::move(ref));
+
+        return inserted;
+    }
+
+    // Returns a new reference to the object, or nullptr if it is not in the set
+    Ref<_Ty> Find(const _Ty* key) const noexcept
+    {
+        const size_t slot = this->_Find(key);
+        if (slot == this->s_NotFound)
+            return nullptr;
+
+        (void)this->m_RefCounts[slot]->IncRef();
+        return _RefAccess::Adopt(this->m_Keys[slot], this->m_RefCounts[slot]);
+    }
+
+    // Removes the object and hands its reference to the caller
+    Ref<_Ty> Extract(const _Ty* key) noexcept
+    {
+        const size_t slot = this->_Find(key);
+        return (slot != this->s_NotFound) ? this->_Remove(slot) : nullptr;
+    }
+
+    template<typename _Fn>
+    void ForEach(_Fn&& fn) const noexcept
+    {
+        for (size_t i = 0; i < this->m_Capacity; ++i)
+        {
+            if (this->m_Keys[i])
+                fn(this->m_Keys[i]);
+        }
+    }
+
+    RefHashSet<_Ty>& operator=(const RefHashSet<_Ty>& other) noexcept
+    {
+        RefHashSet<_Ty>(other).Swap(*this);
+        return *this;
+    }
+
+    RefHashSet<_Ty>& operator=(RefHashSet<_Ty>&& other) noexcept
+    {
+        RefHashSet<_Ty>(std::move(other)).Swap(*this);
+        return *this;
+    }
+};
+
+// A hash map from Refs, compared by object pointer, to values. Lookups take raw pointers and never touch a reference count.
+// Inserting or erasing may move the values, so pointers returned by Find() are only valid until the map is next modified.
+template<typename _Ty, typename _Value>
+class RefHashMap : public _RefHashTable<_Ty, _Value>
+{
+public:
+    RefHashMap(const RefHashMap<_Ty, _Value>& other) noexcept : _RefHashTable<_Ty, _Value>(other) { };
+    RefHashMap(RefHashMap<_Ty, _Value>&& other) noexcept : _RefHashTable<_Ty, _Value>(std::move(other)) { };
+    RefHashMap() noexcept = default;
+
+    void Swap(RefHashMap<_Ty, _Value>& other) noexcept
+    {
+        this->_Swap(other);
+    }
+
+    // Constructs the value if the object is not in the map yet, returns the value of the object and whether it was inserted.
+    // An empty key is never inserted and returns nullptr.
+    template<typename... _Args>
+    std::pair<_Value*, bool> Emplace(const Ref<_Ty>& key, _Args&&... args) noexcept
+    {
+        if (!key)
+            return { nullptr, false };
+
+        auto [slot, inserted] = this->_FindOrReserve(key.Raw());
+        if (inserted)
+            this->_Place(slot, Ref<_Ty>(key), std::forward<_Args>(args)...);
+
+        return { this->m_Values + slot, inserted };
+    }
+
+    template<typename... _Args>
+    std::pair<_Value*, bool> Emplace(Ref<_Ty>&& key, _Args&&... args) noexcept
+    {
+        if (!key)
+            return { nullptr, false };
+
+        auto [slot, inserted] = this->_FindOrReserve(key.Raw());
+        if (inserted)
+            this->_Place(slot, std::move(key), std::forward<_Args>(args)...);
+
+        return { this->m_Values + slot, inserted };
+    }
+
+    // Returns nullptr if the object is not in the map
+    _Value* Find(const _Ty* key) noexcept
+    {
+        const size_t slot = this->_Find(key);
+        return (slot != this->s_NotFound) ? (this->m_Values + slot) : nullptr;
+    }
+
+    const _Value* Find(const _Ty* key) const noexcept
+    {
+        const size_t slot = this->_Find(key);
+        return (slot != this->s_NotFound) ? (this->m_Values + slot) : nullptr;
+    }
+
+    template<typename _Fn>
+    void ForEach(_Fn&& fn) noexcept
+    {
+        for (size_t i = 0; i < this->m_Capacity; ++i)
+        {
+            if (this->m_Keys[i])
+                fn(this->m_Keys[i], this->m_Values[i]);
+        }
+    }
+
+    template<typename _Fn>
+    void ForEach(_Fn&& fn) const noexcept
+    {
+        for (size_t i = 0; i < this->m_Capacity; ++i)
+        {
+            if (this->m_Keys[i])
+                fn(this->m_Keys[i], static_cast<const _Value&>(this->m_Values[i]));
+        }
+    }
+
+    RefHashMap<_Ty, _Value>& operator=(const RefHashMap<_Ty, _Value>& other) noexcept
+    {
+        RefHashMap<_Ty, _Value>(other).Swap(*this);
+        return *this;
+    }
+
+    RefHashMap<_Ty, _Value>& operator=(RefHashMap<_Ty, _Value>&& other) noexcept
+    {
+        RefHashMap<_Ty, _Value>(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    // Default constructs the value if the object is not in the map yet
+    _Value& operator[](const Ref<_Ty>& key) noexcept
+    {
+        return *Emplace(key).first;
+    }
+};
+
+template<typename _Ty>
+struct _RefKey
+{
+    static constexpr const _Ty* Get(const _Ty* ptr) noexcept { return ptr; }
+
+    template<typename _Ty2>
+    static constexpr const _Ty* Get(const Ref<_Ty2>& ref) noexcept { return ref.Raw(); }
+
+    template<typename _Ty2>
+    static constexpr const _Ty* Get(const WeakRef<_Ty2>& ref) noexcept { return ref.Raw(); }
+
+    template<typename _Ty2>
+    static constexpr const _Ty* Get(const Scope<_Ty2>& scope) noexcept { return scope.Raw(); }
+};
+
+// Transparent hash and equality for unordered containers keyed on Ref<_Ty>, WeakRef<_Ty> or Scope<_Ty>. Keys and lookups may be any
+// of those or a raw pointer and are compared by the address of the _Ty they point to, so finding a Ref from a raw pointer needs no
+// temporary Ref. The hash matches std::hash of the smart pointers.
+template<typename _Ty>
+struct RefHash
+{
+    using is_transparent = void;
+
+    template<typename _Key>
+    size_t operator()(const _Key& key) const noexcept
+    {
+        return std::hash<const _Ty*>{}(_RefKey<_Ty>::Get(key));
+    }
+};
+
+template<typename _Ty>
+struct RefEqual
+{
+    using is_transparent = void;
+
+    template<typename _Left, typename _Right>
+    constexpr bool operator()(const _Left& left, const _Right& right) const noexcept
+    {
+        return _RefKey<_Ty>::Get(left) == _RefKey<_Ty>::Get(right);
+    }
+};
+
+template<typename _Ty>
+class SlotMap;
+
+template<typename _Ty, size_t _PageBytes>
+class RelocatableHeap;
+
+// An index and generation identifying an object in a SlotMap.
+// A Handle is invalidated when its object is erased and never matches an object inserted into the same slot later.
+template<typename _Ty>
+class Handle
+{
+public:
+    constexpr Handle(std::nullptr_t) noexcept { };
+    constexpr Handle() noexcept = default;
+
+    constexpr uint32_t Index() const noexcept
+    {
+        return m_Index;
+    }
+
+    constexpr uint32_t Generation() const noexcept
+    {
+        return m_Generation;
+    }
+
+    // Only tells whether this handle was ever assigned, use SlotMap::Contains() to check if it is still alive
+    constexpr bool Valid() const noexcept
+    {
+        return m_Generation != 0;
+    }
+
+    constexpr explicit operator bool() const noexcept { return Valid(); }
+
+    constexpr bool operator==(const Handle<_Ty>& other) const noexcept = default;
+
+private:
+    constexpr Handle(uint32_t index, uint32_t generation) noexcept : m_Index(index), m_Generation(generation) { };
+
+private:
+    friend class SlotMap<_Ty>;
+
+    template<typename _Ty2, size_t _PageBytes>
+    friend class RelocatableHeap;
+
+private:
+    uint32_t m_Index = 0;
+    uint32_t m_Generation = 0;
+};
+
+// Dense storage of objects addressed by generational handles.
+// Lookups are a bounds check and a single generation compare with no reference counting, erasing moves the last object into the hole.
+// Pointers returned by Get() are invalidated by any insertion or erasure, Handles are not.
+template<typename _Ty>
+class SlotMap
+{
+public:
+    using Iterator = typename std::vector<_Ty>::iterator;
+    using ConstIterator = typename std::vector<_Ty>::const_iterator;
+
+    SlotMap() noexcept = default;
+
+    template<typename... _Args>
+    Handle<_Ty> Emplace(_Args&&... args) noexcept
+    {
+        uint32_t slotIndex;
+        if (m_FreeHead != s_NoSlot)
+        {
+            slotIndex = m_FreeHead;
+            m_FreeHead = m_Slots[slotIndex].DenseIndex;
+        }
+        else
+        {
+            slotIndex = static_cast<uint32_t>(m_Slots.size());
+            m_Slots.push_back({ 0, 1 });
+        }
+
+        _Slot& slot = m_Slots[slotIndex];
+        slot.DenseIndex = static_cast<uint32_t>(m_Objects.size());
+
+        m_Objects.emplace_back(std::forward<_Args>(args)...);
+        m_DenseToSlot.push_back(slotIndex);
+
+        return Handle<_Ty>(slotIndex, slot.Generation);
+    }
+
+    Handle<_Ty> Insert(const _Ty& obj) noexcept { return Emplace(obj); }
+    Handle<_Ty> Insert(_Ty&& obj) noexcept { return Emplace(std::move(obj)); }
+
+    bool Contains(Handle<_Ty> handle) const noexcept
+    {
+        return (handle.m_Index < m_Slots.size()) && (m_Slots[handle.m_Index].Generation == handle.m_Generation);
+    }
+
+    _Ty* Get(Handle<_Ty> handle) noexcept
+    {
+        return Contains(handle) ? &m_Objects[m_Slots[handle.m_Index].DenseIndex] : nullptr;
+    }
+
+    const _Ty* Get(Handle<_Ty> handle) const noexcept
+    {
+        return Contains(handle) ? &m_Objects[m_Slots[handle.m_Index].DenseIndex] : nullptr;
+    }
+
+    bool Erase(Handle<_Ty> handle) noexcept
+    {
+        if (!Contains(handle))
+            return false;
+
+        _RemoveSlot(handle.m_Index);
+        return true;
+    }
+
+    // Moves the object out of the map into a newly created Ref for when shared ownership is needed, invalidating the handle
+    Ref<_Ty> ExtractRef(Handle<_Ty> handle) noexcept
+    {
+        _Ty* obj = Get(handle);
+        if (!obj)
+            return nullptr;
+
+        Ref<_Ty> res = CreateRef<_Ty>(std::move(*obj));
+        _RemoveSlot(handle.m_Index);
+
+        return res;
+    }
+
+    // Creates a Ref holding a copy of the object, leaving the map untouched
+    Ref<_Ty> CopyRef(Handle<_Ty> handle) const noexcept
+    {
+        const _Ty* obj = Get(handle);
+        return obj ? CreateRef<_Ty>(*obj) : nullptr;
+    }
+
+    void Clear() noexcept
+    {
+        for (uint32_t slotIndex : m_DenseToSlot)
+            _FreeSlot(slotIndex);
+
+        m_Objects.clear();
+        m_DenseToSlot.clear();
+    }
+
+    void Reserve(size_t capacity) noexcept
+    {
+        m_Objects.reserve(capacity);
+        m_DenseToSlot.reserve(capacity);
+        m_Slots.reserve(capacity);
+    }
+
+    size_t Size() const noexcept
+    {
+        return m_Objects.size();
+    }
+
+    bool Empty() const noexcept
+    {
+        return m_Objects.empty();
+    }
+
+    // The objects in dense order, which changes as objects are erased
+    Iterator begin() noexcept { return m_Objects.begin(); }
+    Iterator end() noexcept { return m_Objects.end(); }
+    ConstIterator begin() const noexcept { return m_Objects.begin(); }
+    ConstIterator end() const noexcept { return m_Objects.end(); }
+
+private:
+    struct _Slot
+    {
+        uint32_t DenseIndex;    // Next free slot while the slot is unused
+        uint32_t Generation;
+    };
+
+    void _RemoveSlot(uint32_t slotIndex) noexcept
+    {
+        uint32_t denseIndex = m_Slots[slotIndex].DenseIndex;
+        uint32_t lastIndex = static_cast<uint32_t>(m_Objects.size() - 1);
+
+        if (denseIndex != lastIndex)
+        {
+            m_Objects[denseIndex] = std::move(m_Objects[lastIndex]);
+            m_DenseToSlot[denseIndex] = m_DenseToSlot[lastIndex];
+            m_Slots[m_DenseToSlot[denseIndex]].DenseIndex = denseIndex;
+        }
+
+        m_Objects.pop_back();
+        m_DenseToSlot.pop_back();
+        _FreeSlot(slotIndex);
+    }
+
+    void _FreeSlot(uint32_t slotIndex) noexcept
+    {
+        _Slot& slot = m_Slots[slotIndex];
+
+        // Generation 0 is reserved for null handles
+        if (++slot.Generation == 0)
+            slot.Generation = 1;
+
+        slot.DenseIndex = m_FreeHead;
+        m_FreeHead = slotIndex;
+    }
+
+private:
+    static constexpr uint32_t s_NoSlot = UINT32_MAX;
+
+    std::vector<_Ty> m_Objects;
+    std::vector<uint32_t> m_DenseToSlot;
+    std::vector<_Slot> m_Slots;
+    uint32_t m_FreeHead = s_NoSlot;
+};
+
+// Allocates memory straight from the OS where possible so that freeing it returns the pages immediately
+inline void* _AllocatePages(size_t size) noexcept
+{
+#ifdef _INTRICATE_POSIX
+    void* res = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return (res == MAP_FAILED) ? nullptr : res;
+#else
+    return ::operator new(size, std::align_val_t(4096), std::nothrow);
+#endif
+}
+
+inline void _FreePages(void* pages, size_t size) noexcept
+{
+#ifdef _INTRICATE_POSIX
+    (void)::munmap(pages, size);
+#else
+    (void)size;
+    ::operator delete(pages, std::align_val_t(4096), std::nothrow);
+#endif
+}
+
+struct CompactionStats
+{
+    size_t MovedObjects = 0;
+    size_t ReleasedPages = 0;
+    size_t ReclaimedBytes = 0;
+};
+
+struct RelocatableHeapStats
+{
+    size_t Objects = 0;
+    size_t Pages = 0;
+    size_t CommittedBytes = 0;
+    size_t TotalMovedObjects = 0;
+    size_t TotalReclaimedBytes = 0;
+};
+
+// Guard returned by RelocatableHeap::Pin() that keeps its object from being moved by Compact() while alive
+template<typename _Ty>
+class Pinned
+{
+public:
+    constexpr Pinned(Pinned<_Ty>&& other) noexcept : m_Ptr(std::exchange(other.m_Ptr, nullptr)), m_PinCount(std::exchange(other.m_PinCount, nullptr)) { };
+    constexpr Pinned(std::nullptr_t) noexcept { };
+    constexpr Pinned() noexcept = default;
+
+    Pinned(const Pinned<_Ty>&) = delete;
+    Pinned<_Ty>& operator=(const Pinned<_Ty>&) = delete;
+
+    constexpr ~Pinned() noexcept
+    {
+        if (m_PinCount)
+            --(*m_PinCount);
+    }
+
+    constexpr _Ty* Raw() const noexcept
+    {
+        return m_Ptr;
+    }
+
+    constexpr bool Valid() const noexcept
+    {
+        return Raw() != nullptr;
+    }
+
+    constexpr explicit operator bool() const noexcept { return Valid(); }
+
+    constexpr Pinned<_Ty>& operator=(Pinned<_Ty>&& other) noexcept
+    {
+        Pinned<_Ty> tmp(std::move(other));
+        std::swap(m_Ptr, tmp.m_Ptr);
+        std::swap(m_PinCount, tmp.m_PinCount);
+        return *this;
+    }
+
+    constexpr _Ty* operator->() const noexcept { return Raw(); }
+    constexpr _Ty& operator*() const noexcept { return *Raw(); }
+
+private:
+    constexpr Pinned(_Ty* ptr, uint32_t* pinCount) noexcept : m_Ptr(ptr), m_PinCount(pinCount)
+    {
+        ++(*m_PinCount);
+    }
+
+private:
+    template<typename _Ty2, size_t _PageBytes>
+    friend class RelocatableHeap;
+
+private:
+    _Ty* m_Ptr = nullptr;
+    uint32_t* m_PinCount = nullptr;
+};
+
+// Page-based storage of objects addressed through an indirection table by generational handles.
+// Since nothing outside the heap holds the address of an unpinned object, Compact() is free to move objects out of
+// sparsely populated pages into denser ones and hand pages that become empty back to the OS.
+// Pointers from Get() stay valid until the next Compact() or erasure, a Pinned guard keeps them valid for longer.
+// A RelocatableHeap is not thread-safe.
+template<typename _Ty, size_t _PageBytes = 64 * 1024>
+class RelocatableHeap
+{
+public:
+    RelocatableHeap() noexcept = default;
+
+    ~RelocatableHeap() noexcept
+    {
+        Clear();
+        for (_Page* page : m_Pages)
+        {
+            // Pages released by Compact() leave their slot empty
+            if (page)
+                _FreePages(page, sizeof(_Page));
+        }
+    }
+
+    RelocatableHeap(const RelocatableHeap&) = delete;
+    RelocatableHeap& operator=(const RelocatableHeap&) = delete;
+
+    template<typename... _Args>
+    Handle<_Ty> Emplace(_Args&&... args) noexcept
+    {
+        uint32_t pageIndex = _FindPageWithSpace();
+        _Page* page = m_Pages[pageIndex];
+        uint32_t slot = page->FreeSlots[--page->FreeCount];
+
+        uint32_t entryIndex;
+        if (m_FreeEntry != s_None)
+        {
+            entryIndex = m_FreeEntry;
+            m_FreeEntry = m_Entries[entryIndex].Slot;
+        }
+        else
+        {
+            entryIndex = static_cast<uint32_t>(m_Entries.size());
+            m_Entries.push_back({ nullptr, 0, 0, 1 });
+        }
+
+        _Entry& entry = m_Entries[entryIndex];
+        entry.Ptr = ::new (static_cast<void*>(page->Object(slot))) _Ty(std::forward<_Args>(args)...);
+        entry.Page = pageIndex;
+        entry.Slot = slot;
+
+        page->Owners[slot] = entryIndex;
+        page->Pins[slot] = 0;
+        ++page->Live;
+        ++m_Objects;
+
+        return Handle<_Ty>(entryIndex, entry.Generation);
+    }
+
+    bool Contains(Handle<_Ty> handle) const noexcept
+    {
+        return (handle.m_Index < m_Entries.size()) && (m_Entries[handle.m_Index].Generation == handle.m_Generation);
+    }
+
+    _Ty* Get(Handle<_Ty> handle) const noexcept
+    {
+        return Contains(handle) ? m_Entries[handle.m_Index].Ptr : nullptr;
+    }
+
+    Pinned<_Ty> Pin(Handle<_Ty> handle) noexcept
+    {
+        if (!Contains(handle))
+            return nullptr;
+
+        // Pages never move and a page holding a pinned object is never released, so the counter stays put
+        const _Entry& entry = m_Entries[handle.m_Index];
+        return Pinned<_Ty>(entry.Ptr, &m_Pages[entry.Page]->Pins[entry.Slot]);
+    }
+
+    // Erasing a pinned object is a logic error and leaves its Pinned guard dangling
+    bool Erase(Handle<_Ty> handle) noexcept
+    {
+        if (!Contains(handle))
+            return false;
+
+        _Remove(handle.m_Index);
+        return true;
+    }
+
+    void Clear() noexcept
+    {
+        for (uint32_t i = 0; i < m_Entries.size(); ++i)
+        {
+            if (m_Entries[i].Ptr)
+                _Remove(i);
+        }
+    }
+
+    // Moves at most budget unpinned objects from the sparsest pages into the densest pages with free slots,
+    // then releases every page left empty back to the OS
+    CompactionStats Compact(size_t budget) noexcept
+    {
+        CompactionStats stats;
+
+        std::vector<uint32_t> order;
+        order.reserve(m_Pages.size());
+        for (uint32_t i = 0; i < m_Pages.size(); ++i)
+        {
+            if (m_Pages[i])
+                order.push_back(i);
+        }
+
+        std::sort(order.begin(), order.end(), [this](uint32_t left, uint32_t right) { return m_Pages[left]->Live < m_Pages[right]->Live; });
+
+        size_t source = 0;
+        size_t destination = order.size();
+        while ((budget > 0) && (source < destination))
+        {
+            _Page* sourcePage = m_Pages[order[source]];
+            if ((sourcePage->Live == 0) || _HasPins(sourcePage))
+            {
+                ++source;
+                continue;
+            }
+
+            while ((destination > (source + 1)) && (m_Pages[order[destination - 1]]->FreeCount == 0))
+                --destination;
+
+            if (destination <= (source + 1))
+                break;
+
+            _Page* destinationPage = m_Pages[order[destination - 1]];
+            while ((budget > 0) && (sourcePage->Live > 0) && (destinationPage->FreeCount > 0))
+            {
+                _Move(order[source], order[destination - 1]);
+                ++stats.MovedObjects;
+                --budget;
+            }
+
+            if (sourcePage->Live == 0)
+                ++source;
+        }
+
+        for (uint32_t i = 0; i < m_Pages.size(); ++i)
+        {
+            if (m_Pages[i] && (m_Pages[i]->Live == 0))
+            {
+                _FreePages(m_Pages[i], sizeof(_Page));
+                m_Pages[i] = nullptr;
+
+                ++stats.ReleasedPages;
+                stats.ReclaimedBytes += sizeof(_Page);
+            }
+        }
+
+        m_TotalMovedObjects += stats.MovedObjects;
+        m_TotalReclaimedBytes += stats.ReclaimedBytes;
+        return stats;
+    }
+
+    RelocatableHeapStats GetStats() const noexcept
+    {
+        RelocatableHeapStats stats;
+        stats.Objects = m_Objects;
+        stats.Pages = static_cast<size_t>(std::count_if(m_Pages.begin(), m_Pages.end(), [](const _Page* page) { return page != nullptr; }));
+        stats.CommittedBytes = stats.Pages * sizeof(_Page);
+        stats.TotalMovedObjects = m_TotalMovedObjects;
+        stats.TotalReclaimedBytes = m_TotalReclaimedBytes;
+
+        return stats;
+    }
+
+    size_t Size() const noexcept
+    {
+        return m_Objects;
+    }
+
+    bool Empty() const noexcept
+    {
+        return m_Objects == 0;
+    }
+
+private:
+    static constexpr uint32_t s_None = UINT32_MAX;
+    static constexpr uint32_t s_ObjectsPerPage = static_cast<uint32_t>(std::max<size_t>(1, (_PageBytes - 64) / (sizeof(_Ty) + (3 * sizeof(uint32_t)))));
+
+    struct _Page
+    {
+        uint32_t Live;
+        uint32_t FreeCount;
+        uint32_t Owners[s_ObjectsPerPage];      // Entry of the object in each slot
+        uint32_t FreeSlots[s_ObjectsPerPage];
+        uint32_t Pins[s_ObjectsPerPage];
+        alignas(_Ty) std::byte Storage[s_ObjectsPerPage * sizeof(_Ty)];
+
+        _Ty* Object(uint32_t slot) noexcept
+        {
+            return reinterpret_cast<_Ty*>(Storage) + slot;
+        }
+    };
+
+    struct _Entry
+    {
+        _Ty* Ptr;           // nullptr while the entry is unused
+        uint32_t Page;
+        uint32_t Slot;      // Next free entry while the entry is unused
+        uint32_t Generation;
+    };
+
+    uint32_t _FindPageWithSpace() noexcept
+    {
+        if ((m_InsertPage < m_Pages.size()) && m_Pages[m_InsertPage] && (m_Pages[m_InsertPage]->FreeCount > 0))
+            return m_InsertPage;
+
+        m_InsertPage = _SelectPageWithSpace();
+        return m_InsertPage;
+    }
+
+    uint32_t _SelectPageWithSpace() noexcept
+    {
+        // Fill the fullest page first to keep the heap dense between compactions
+        uint32_t best = s_None;
+        uint32_t hole = s_None;
+        for (uint32_t i = 0; i < m_Pages.size(); ++i)
+        {
+            _Page* page = m_Pages[i];
+            if (!page)
+                hole = i;
+            else if ((page->FreeCount > 0) && ((best == s_None) || (page->Live > m_Pages[best]->Live)))
+                best = i;
+        }
+
+        if (best != s_None)
+            return best;
+
+        _Page* page = static_cast<_Page*>(_AllocatePages(sizeof(_Page)));
+        if (!page)
+            std::terminate();
+
+        page->Live = 0;
+        page->FreeCount = s_ObjectsPerPage;
+        for (uint32_t slot = 0; slot < s_ObjectsPerPage; ++slot)
+        {
+            page->Owners[slot] = s_None;
+            page->FreeSlots[slot] = s_ObjectsPerPage - slot - 1;
+        }
+
+        if (hole != s_None)
+        {
+            m_Pages[hole] = page;
+            return hole;
+        }
+
+        m_Pages.push_back(page);
+        return static_cast<uint32_t>(m_Pages.size() - 1);
+    }
+
+    bool _HasPins(_Page* page) const noexcept
+    {
+        for (uint32_t slot = 0; slot < s_ObjectsPerPage; ++slot)
+        {
+            if ((page->Owners[slot] != s_None) && (page->Pins[slot] > 0))
+                return true;
+        }
+
+        return false;
+    }
+
+    void _Move(uint32_t sourcePageIndex, uint32_t destinationPageIndex) noexcept
+    {
+        _Page* sourcePage = m_Pages[sourcePageIndex];
+        _Page* destinationPage = m_Pages[destinationPageIndex];
+
+        uint32_t sourceSlot = 0;
+        while (sourcePage->Owners[sourceSlot] == s_None)
+            ++sourceSlot;
+
+        uint32_t entryIndex = sourcePage->Owners[sourceSlot];
+        uint32_t destinationSlot = destinationPage->FreeSlots[--destinationPage->FreeCount];
+
+        _Entry& entry = m_Entries[entryIndex];
+        entry.Ptr = ::new (static_cast<void*>(destinationPage->Object(destinationSlot))) _Ty(std::move(*sourcePage->Object(sourceSlot)));
+        entry.Page = destinationPageIndex;
+        entry.Slot = destinationSlot;
+        sourcePage->Object(sourceSlot)->~_Ty();
+
+        destinationPage->Owners[destinationSlot] = entryIndex;
+        destinationPage->Pins[destinationSlot] = 0;
+        ++destinationPage->Live;
+
+        sourcePage->Owners[sourceSlot] = s_None;
+        sourcePage->FreeSlots[sourcePage->FreeCount++] = sourceSlot;
+        --sourcePage->Live;
+    }
+
+    void _Remove(uint32_t entryIndex) noexcept
+    {
+        _Entry& entry = m_Entries[entryIndex];
+        _Page* page = m_Pages[entry.Page];
+
+        entry.Ptr->~_Ty();
+        page->Owners[entry.Slot] = s_None;
+        page->FreeSlots[page->FreeCount++] = entry.Slot;
+        --page->Live;
+        --m_Objects;
+
+        // Generation 0 is reserved for null handles
+        if (++entry.Generation == 0)
+            entry.Generation = 1;
+
+        entry.Ptr = nullptr;
+        entry.Slot = m_FreeEntry;
+        m_FreeEntry = entryIndex;
+    }
+
+private:
+    std::vector<_Page*> m_Pages;    // nullptr where a page was released
+    std::vector<_Entry> m_Entries;
+    uint32_t m_FreeEntry = s_None;
+    uint32_t m_InsertPage = s_None;
+    size_t m_Objects = 0;
+
+    size_t m_TotalMovedObjects = 0;
+    size_t m_TotalReclaimedBytes = 0;
+};
+
+// Locks every WeakRef in weakRefs and appends a Ref to each live object to out, prefetching control blocks ahead of the upgrades.
+// Each upgrade is a single relaxed compare-exchange on the strong count with no separate Expired() load.
+// Expired and empty entries are released and the live ones are moved to the front in their original order.
+// Returns the number of live entries, the entries past it are left empty.
+template<typename _Ty>
+static size_t LockAll(std::span<WeakRef<_Ty>> weakRefs, std::vector<Ref<_Ty>>& out) noexcept
+{
+    out.reserve(out.size() + weakRefs.size());
+    size_t live = 0;
+
+    for (size_t i = 0; i < weakRefs.size(); ++i)
+    {
+        if ((i + _BulkPrefetchDistance) < weakRefs.size())
+            _INTRICATE_PREFETCH(_RefAccess::GetRefCount(weakRefs[i + _BulkPrefetchDistance]));
+
+        WeakRef<_Ty>& weak = weakRefs[i];
+        _RefCountType<_Ty>* refCount = _RefAccess::GetRefCount(weak);
+
+        if (!refCount || !refCount->TryIncRef())
+        {
+            weak = nullptr;
+            continue;
+        }
+
+        out.push_back(_RefAccess::Adopt(weak.Raw(), refCount));
+        if (live != i)
+            weakRefs[live] = std::move(weak);
+
+        ++live;
+    }
+
+    return live;
+}
+
+// Erases the expired and empty entries from weakRefs
+template<typename _Ty>
+static void LockAll(std::vector<WeakRef<_Ty>>& weakRefs, std::vector<Ref<_Ty>>& out) noexcept
+{
+    weakRefs.resize(LockAll(std::span<WeakRef<_Ty>>(weakRefs), out));
+}
+
+// A WeakRef that stores nothing but its control block pointer, which halves its size. The object is found through the control
+// block, and the distance between the object as created and the _Ty it is observed as, such as a base class at a non-zero offset,
+// is packed into the upper 16 bits of the pointer that 64-bit platforms leave unused. An aliasing Ref pointing further than
+// 32 KiB from the object that owns it, or a control block whose address uses those upper bits as with tagged pointers or 5-level
+// paging, is instead stored out of line in a small allocation owned by the CompactWeakRef, marked by the lowest bit.
+template<typename _Ty>
+class CompactWeakRef
+{
+public:
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    CompactWeakRef(const Ref<_Ty2>& ref) noexcept : m_Packed(_Pack(ref.Raw(), _RefAccess::GetRefCount(ref))) { _IncWeakRef(); }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    CompactWeakRef(const WeakRef<_Ty2>& weak) noexcept : m_Packed(_Pack(weak.Raw(), _RefAccess::GetRefCount(weak))) { _IncWeakRef(); }
+
+    CompactWeakRef(const CompactWeakRef<_Ty>& other) noexcept : m_Packed(other._Copy()) { _IncWeakRef(); }
+    CompactWeakRef(CompactWeakRef<_Ty>&& other) noexcept : m_Packed(std::exchange(other.m_Packed, 0)) { };
+    constexpr CompactWeakRef(std::nullptr_t) noexcept { };
+    constexpr CompactWeakRef() noexcept = default;
+
+    ~CompactWeakRef() noexcept
+    {
+        static_assert(_EnableWeakRefsV<_Ty>, "CompactWeakRef cannot be used with a type whose EnableWeakRefs trait is false");
+
+        if (_RefCountType<_Ty>* refCount = _GetRefCount())
+            refCount->ReleaseWeak();
+
+        delete _GetSpilled();
+    }
+
+    void Swap(CompactWeakRef<_Ty>& other) noexcept
+    {
+        std::swap(m_Packed, other.m_Packed);
+    }
+
+    void Reset() noexcept
+    {
+        CompactWeakRef<_Ty>(nullptr).Swap(*this);
+    }
+
+    uint32_t RefCount() const noexcept
+    {
+        _RefCountType<_Ty>* refCount = _GetRefCount();
+        return refCount ? refCount->GetStrongs() : 0;
+    }
+
+    bool Unique() const noexcept
+    {
+        return RefCount() == 1;
+    }
+
+    bool Expired() const noexcept
+    {
+        return RefCount() == 0;
+    }
+
+    constexpr bool Valid() const noexcept
+    {
+        return m_Packed != 0;
+    }
+
+    Ref<_Ty> Lock() const noexcept
+    {
+        _RefCountType<_Ty>* refCount = _GetRefCount();
+        if (!refCount || !refCount->TryIncRef())
+            return nullptr;
+
+        if (_Spilled* spilled = _GetSpilled())
+            return _RefAccess::Adopt(spilled->Ptr, refCount);
+
+        const uintptr_t object = reinterpret_cast<uintptr_t>(refCount->GetObject()) + static_cast<uintptr_t>(_GetOffset());
+        return _RefAccess::Adopt(reinterpret_cast<_Ty*>(object), refCount);
+    }
+
+    constexpr explicit operator bool() const noexcept { return Valid(); }
+
+    CompactWeakRef<_Ty>& operator=(const CompactWeakRef<_Ty>& other) noexcept
+    {
+        CompactWeakRef<_Ty>(other).Swap(*this);
+        return *this;
+    }
+
+    CompactWeakRef<_Ty>& operator=(CompactWeakRef<_Ty>&& other) noexcept
+    {
+        CompactWeakRef<_Ty>(std::move(other)).Swap(*this);
+        return *this;
+    }
+
+    template<typename _Ty2, std::enable_if_t<_IsPtrConvertibleV<_Ty2, _Ty>, int> = 0>
+    CompactWeakRef<_Ty>& operator=(const Ref<_Ty2>& ref) noexcept
+    {
+        CompactWeakRef<_Ty>(ref).Swap(*this);
+        return *this;
+    }
+
+    CompactWeakRef<_Ty>& operator=(std::nullptr_t) noexcept
+    {
+        Reset();
+        return *this;
+    }
+
+private:
+    static_assert(sizeof(uintptr_t) == 8, "CompactWeakRef requires 64-bit pointers");
+
+    static_assert(alignof(_RefCountType<_Ty>) > 1, "The lowest bit of a control block address must be free to mark spilled references");
+
+    // The control block and pointer of a reference that cannot be packed into a single word
+    struct _Spilled
+    {
+        _RefCountType<_Ty>* RefCount;
+        _Ty* Ptr;
+    };
+
+    static constexpr uint32_t s_OffsetShift = 48;
+    static constexpr uintptr_t s_RefCountMask = (uintptr_t(1) << s_OffsetShift) - 1;
+    static constexpr uintptr_t s_SpilledTag = 1;
+
+    static uintptr_t _Pack(_Ty* ptr, _RefCountType<_Ty>* refCount) noexcept
+    {
+        if (!refCount)
+            return 0;
+
+        const uintptr_t address = reinterpret_cast<uintptr_t>(refCount);
+        const intptr_t offset = static_cast<intptr_t>(reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(refCount->GetObject()));
+        if ((address & ~s_RefCountMask) || (offset < INT16_MIN) || (offset > INT16_MAX))
+            return reinterpret_cast<uintptr_t>(new _Spilled{ refCount, ptr }) | s_SpilledTag;
+
+        return address | (static_cast<uintptr_t>(static_cast<uint16_t>(offset)) << s_OffsetShift);
+    }
+
+    // A copy of m_Packed that owns its own out of line record, if there is one
+    uintptr_t _Copy() const noexcept
+    {
+        if (_Spilled* spilled = _GetSpilled())
+            return reinterpret_cast<uintptr_t>(new _Spilled(*spilled)) | s_SpilledTag;
+
+        return m_Packed;
+    }
+
+    _Spilled* _GetSpilled() const noexcept
+    {
+        return (m_Packed & s_SpilledTag) ? reinterpret_cast<_Spilled*>(m_Packed & ~s_SpilledTag) : nullptr;
+    }
+
+    _RefCountType<_Ty>* _GetRefCount() const noexcept
+    {
+        if (_Spilled* spilled = _GetSpilled())
+            return spilled->RefCount;
+
+        return reinterpret_cast<_RefCountType<_Ty>*>(m_Packed & s_RefCountMask);
+    }
+
+    intptr_t _GetOffset() const noexcept
+    {
+        return static_cast<int16_t>(static_cast<uint16_t>(m_Packed >> s_OffsetShift));
+    }
+
+    void _IncWeakRef() noexcept
+    {
+        if (_RefCountType<_Ty>* refCount = _GetRefCount())
+            (void)refCount->IncWeakRef();
+    }
+
+private:
+    uintptr_t m_Packed = 0;
+};
+
+// Derive _Ty from EnableRefFromThis<_Ty> to let objects owned by a Ref hand out Refs and WeakRefs to themselves.
+// CreateRef, CreateRefs and Ref(_Ty*) point the base at the object's control block, so RefFromThis() needs no lookup
+// or allocation, and constructing a Ref from the raw pointer of an object that is already owned shares its control block.
+template<typename _Ty>
+class EnableRefFromThis
+{
+public:
+    using _RefFromThisType = _Ty;
+
+    // Returns nullptr when the object is not owned by a Ref
+    Ref<_Ty> RefFromThis() noexcept
+    {
+        return m_WeakThis.Lock();
+    }
+
+    Ref<const _Ty> RefFromThis() const noexcept
+    {
+        return m_WeakThis.Lock();
+    }
+
+    WeakRef<_Ty> WeakFromThis() noexcept
+    {
+        return m_WeakThis;
+    }
+
+    WeakRef<const _Ty> WeakFromThis() const noexcept
+    {
+        return m_WeakThis;
+    }
+
+protected:
+    constexpr EnableRefFromThis() noexcept = default;
+    constexpr ~EnableRefFromThis() noexcept = default;
+
+    // Copies are owned separately from the original
+    constexpr EnableRefFromThis(const EnableRefFromThis<_Ty>&) noexcept { };
+    constexpr EnableRefFromThis<_Ty>& operator=(const EnableRefFromThis<_Ty>&) noexcept { return *this; }
+
+private:
+    template<typename _Ty2>
+    friend class _RefBase;
+
+private:
+    mutable WeakRef<_Ty> m_WeakThis;
+};
+
+// Specialize this trait to let RefCast check downcasts without dynamic_cast. Number the classes of a hierarchy in depth-first order
+// so that the subclasses of a class take the IDs (First, Last] and give each class { static constexpr uint32_t First, Last; }.
+// Objects report the ID of their most derived class through a 'uint32_t GetRefTypeId() const noexcept' member.
+template<typename _Ty>
+struct RefTypeInfo;
+
+template<typename _Ty, typename = void>
+struct _HasRefTypeInfo : std::false_type { };
+
+template<typename _Ty>
+struct _HasRefTypeInfo<_Ty, std::void_t<decltype(RefTypeInfo<_Ty>::First)>> : std::true_type { };
+
+template<typename _Ty>
+constexpr bool _HasRefTypeInfoV = _HasRefTypeInfo<std::remove_cv_t<_Ty>>::value;
+
+template<typename _Ty, typename _Ty2>
+constexpr static bool _IsRefType(const _Ty2* ptr) noexcept
+{
+    if constexpr (_IsPtrConvertibleV<_Ty2, _Ty>)
+    {
+        return ptr != nullptr;
+    }
+    else
+    {
+        static_assert(_HasRefTypeInfoV<_Ty>, "RefCast to a derived type requires a RefTypeInfo specialization for it");
+        using _Info = RefTypeInfo<std::remove_cv_t<_Ty>>;
+
+        // A single unsigned compare checks First <= id <= Last
+        return ptr && (static_cast<uint32_t>(ptr->GetRefTypeId() - _Info::First) <= static_cast<uint32_t>(_Info::Last - _Info::First));
+    }
+}
+
+// The RefCasts return nullptr, leaving the source untouched, if the object is not a _Ty
+template<typename _Ty, typename _Ty2>
+constexpr static Ref<_Ty> RefCast(const Ref<_Ty2>& ref) noexcept
+{
+    return _IsRefType<_Ty>(ref.Raw()) ? Ref<_Ty>(ref, static_cast<_Ty*>(ref.Raw())) : nullptr;
+}
+
+template<typename _Ty, typename _Ty2>
+constexpr static Ref<_Ty> RefCast(Ref<_Ty2>&& ref) noexcept
+{
+    if (!_IsRefType<_Ty>(ref.Raw()))
+        return nullptr;
+
+    _Ty* ptr = static_cast<_Ty*>(ref.Raw());
+    return Ref<_Ty>(std::move(ref), ptr);
+}
+
+// The object is locked while its type is checked, an expired WeakRef casts to an empty one
+template<typename _Ty, typename _Ty2>
+constexpr static WeakRef<_Ty> RefCast(const WeakRef<_Ty2>& weak) noexcept
+{
+    Ref<_Ty2> locked = weak.Lock();
+    return _IsRefType<_Ty>(locked.Raw()) ? WeakRef<_Ty>(weak, static_cast<_Ty*>(locked.Raw())) : WeakRef<_Ty>();
+}
+
+template<typename _Ty, typename _Ty2>
+constexpr static Scope<_Ty> RefCast(Scope<_Ty2>&& scope) noexcept
+{
+    if (!_IsRefType<_Ty>(scope.Raw()))
+        return nullptr;
+
+    return Scope<_Ty>(static_cast<_Ty*>(scope.Release()));
+}
+
+// Ref graph archives: SaveRefGraph writes every object reachable from a set of roots through Ref<_Ty> edges exactly once, in
+// breadth-first order, and records each Ref and WeakRef edge as the index of its target. LoadRefGraph creates every object with a
+// single CreateRefs call and then reconnects the edges, restoring the same sharing and weak structure.
+// _Ty must be default constructible and have a 'template<typename _Archive> void Serialize(_Archive& archive)' member that passes
+// each persistent field to archive.Field(). Fields may be trivially copyable values, std::strings, Ref<_Ty>s, WeakRef<_Ty>s or
+// std::vectors of those. WeakRefs to objects that are not reachable through Refs are restored empty.
+// Archives use the byte order and layout of the machine that wrote them, and are rejected unless their version matches.
+inline constexpr uint32_t _RefGraphMagic = 0x47525049;  // "IPRG"
+inline constexpr uint32_t _RefGraphVersion = 1;
+inline constexpr uint64_t _RefGraphNullIndex = UINT64_MAX;
+
+template<typename _Ty>
+class _RefGraphCollector
+{
+public:
+    // Returns the index of the object, assigning the next one if it has not been seen yet
+    uint64_t Add(const Ref<_Ty>& ref) noexcept
+    {
+        if (!ref)
+            return _RefGraphNullIndex;
+
+        auto [index, inserted] = m_Indices.Emplace(ref, m_Objects.size());
+        if (inserted)
+            m_Objects.push_back(ref);
+
+        return *index;
+    }
+
+    void Collect() noexcept
+    {
+        // m_Objects grows while it is visited, which yields breadth-first order
+        for (size_t i = 0; i < m_Objects.size(); ++i)
+            m_Objects[i]->Serialize(*this);
+    }
+
+    uint64_t IndexOf(const _Ty* ptr) const noexcept
+    {
+        const uint64_t* index = m_Indices.Find(ptr);
+        return index ? *index : _RefGraphNullIndex;
+    }
+
+    const std::vector<Ref<_Ty>>& GetObjects() const noexcept
+    {
+        return m_Objects;
+    }
+
+    template<typename _Field>
+    void Field(_Field& field) noexcept
+    {
+        if constexpr (std::is_same_v<_Field, Ref<_Ty>>)
+        {
+            Add(field);
+        }
+        else if constexpr (_IsVector<_Field>::value)
+        {
+            for (auto& element : field)
+                Field(element);
+        }
+    }
+
+private:
+    template<typename _Field>
+    struct _IsVector : std::false_type { };
+
+    template<typename _Elem, typename _Alloc>
+    struct _IsVector<std::vector<_Elem, _Alloc>> : std::true_type { };
+
+private:
+    RefHashMap<_Ty, uint64_t> m_Indices;
+    std::vector<Ref<_Ty>> m_Objects;
+};
+
+// Counts the fewest bytes any object of _Ty takes in an archive: strings and vectors take at least their count, whatever
+// the probed object holds
+template<typename _Ty>
+class _RefGraphSizer
+{
+public:
+    size_t GetSize() const noexcept
+    {
+        return m_Size;
+    }
+
+    template<typename _Field>
+    void Field(_Field&) noexcept
+    {
+        if constexpr (std::is_same_v<_Field, Ref<_Ty>> || std::is_same_v<_Field, WeakRef<_Ty>> || !std::is_trivially_copyable_v<_Field>)
+            m_Size += sizeof(uint64_t);
+        else
+            m_Size += sizeof(_Field);
+    }
+
+private:
+    size_t m_Size = 0;
+};
+
+// Empties every Ref and WeakRef field, breaking the cycles of a partially loaded graph so that it can be released
+template<typename _Ty>
+class _RefGraphUnlinker
+{
+public:
+    template<typename _Field>
+    void Field(_Field& field) noexcept
+    {
+        if constexpr (std::is_same_v<_Field, Ref<_Ty>> || std::is_same_v<_Field, WeakRef<_Ty>>)
+        {
+            field = nullptr;
+        }
+        else if constexpr (!std::is_same_v<_Field, std::string> && !std::is_trivially_copyable_v<_Field>)
+        {
+            for (auto& element : field)
+                Field(element);
+        }
+    }
+};
+
+template<typename _Ty>
+class _RefGraphWriter
+{
+public:
+    _RefGraphWriter(const _RefGraphCollector<_Ty>& collector, std::vector<std::byte>& out) noexcept : m_Collector(collector), m_Out(out) { };
+
+    void Write(const void* data, size_t size) noexcept
+    {
+        const std::byte* bytes = static_cast<const std::byte*>(data);
+        m_Out.insert(m_Out.end(), bytes, bytes + size);
+    }
+
+    template<typename _Field>
+    void Field(_Field& field) noexcept
+    {
+        if constexpr (std::is_same_v<_Field, Ref<_Ty>>)
+        {
+            Field(field ? m_Collector.IndexOf(field.Raw()) : _RefGraphNullIndex);
+        }
+        else if constexpr (std::is_same_v<_Field, WeakRef<_Ty>>)
+        {
+            // Locked so that an expired WeakRef is never matched against a new object at the same address
+            Ref<_Ty> locked = field.Lock();
+            Field(locked ? m_Collector.IndexOf(locked.Raw()) : _RefGraphNullIndex);
+        }
+        else if constexpr (std::is_same_v<_Field, std::string>)
+        {
+            Field(static_cast<const uint64_t&>(field.size()));
+            Write(field.data(), field.size());
+        }
+        else if constexpr (std::is_trivially_copyable_v<_Field>)
+        {
+            Write(&field, sizeof(_Field));
+        }
+        else
+        {
+            Field(static_cast<const uint64_t&>(field.size()));
+            for (auto& element : field)
+                Field(element);
+        }
+    }
+
+    template<typename _Field>
+    void Field(const _Field& field) noexcept
+    {
+        static_assert(std::is_trivially_copyable_v<_Field>, "Only trivially copyable fields can be written from a const value");
+        Write(&field, sizeof(_Field));
+    }
+
+private:
+    const _RefGraphCollector<_Ty>& m_Collector;
+    std::vector<std::byte>& m_Out;
+};
+
+template<typename _Ty>
+class _RefGraphReader
+{
+public:
+    _RefGraphReader(std::span<const std::byte> data, const std::vector<Ref<_Ty>>& objects) noexcept : m_Data(data), m_Objects(objects) { };
+
+    bool Read(void* data, size_t size) noexcept
+    {
+        if (m_Failed || (size > (m_Data.size() - m_Offset)))
+        {
+            m_Failed = true;
+            return false;
+        }
+
+        std::copy_n(m_Data.data() + m_Offset, size, static_cast<std::byte*>(data));
+        m_Offset += size;
+        return true;
+    }
+
+    // Reads an object index, returning false if it is neither null nor in range
+    bool ReadIndex(uint64_t& index) noexcept
+    {
+        if (Read(&index, sizeof(index)) && ((index == _RefGraphNullIndex) || (index < m_Objects.size())))
+            return true;
+
+        m_Failed = true;
+        return false;
+    }
+
+    bool Failed() const noexcept
+    {
+        return m_Failed;
+    }
+
+    template<typename _Field>
+    void Field(_Field& field) noexcept
+    {
+        if constexpr (std::is_same_v<_Field, Ref<_Ty>> || std::is_same_v<_Field, WeakRef<_Ty>>)
+        {
+            uint64_t index;
+            if (ReadIndex(index))
+                field = (index == _RefGraphNullIndex) ? Ref<_Ty>() : m_Objects[index];
+        }
+        else if constexpr (std::is_same_v<_Field, std::string>)
+        {
+            uint64_t size;
+            if (Read(&size, sizeof(size)) && (size <= (m_Data.size() - m_Offset)))
+            {
+                field.resize(size);
+                Read(field.data(), size);
+            }
+            else
+            {
+                m_Failed = true;
+            }
+        }
+        else if constexpr (std::is_trivially_copyable_v<_Field>)
+        {
+            Read(&field, sizeof(_Field));
+        }
+        else
+        {
+            // Every element takes at least one byte, which bounds the size of a corrupt count
+            uint64_t size;
+            if (Read(&size, sizeof(size)) && (size <= (m_Data.size() - m_Offset)))
+            {
+                field.resize(size);
+                for (auto& element : field)
+                    Field(element);
+            }
+            else
+            {
+                m_Failed = true;
+            }
+        }
+    }
+
+private:
+    std::span<const std::byte> m_Data;
+    const std::vector<Ref<_Ty>>& m_Objects;
+    size_t m_Offset = 0;
+    bool m_Failed = false;
+};
+
+// Writes the graph reachable from roots, empty roots are preserved
+template<typename _Ty>
+static std::vector<std::byte> SaveRefGraph(std::span<const Ref<_Ty>> roots) noexcept
+{
+    _RefGraphCollector<_Ty> collector;
+    std::vector<uint64_t> rootIndices;
+    rootIndices.reserve(roots.size());
+
+    for (const Ref<_Ty>& root : roots)
+        rootIndices.push_back(collector.Add(root));
+
+    collector.Collect();
+
+    std::vector<std::byte> res;
+    _RefGraphWriter<_Ty> writer(collector, res);
+    writer.Field(_RefGraphMagic);
+    writer.Field(_RefGraphVersion);
+    writer.Field(static_cast<const uint64_t&>(collector.GetObjects().size()));
+    writer.Field(static_cast<const uint64_t&>(rootIndices.size()));
+    writer.Write(rootIndices.data(), rootIndices.size() * sizeof(uint64_t));
+
+    for (const Ref<_Ty>& object : collector.GetObjects())
+        object->Serialize(writer);
+
+    return res;
+}
+
+// Restores a graph written by SaveRefGraph into roots. Returns false, leaving roots empty, if data is not a complete archive.
+template<typename _Ty>
+static bool LoadRefGraph(std::span<const std::byte> data, std::vector<Ref<_Ty>>& roots) noexcept
+{
+    roots.clear();
+
+    std::vector<Ref<_Ty>> objects;
+    _RefGraphReader<_Ty> header(data, objects);
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t objectCount = 0;
+    uint64_t rootCount = 0;
+    if (!header.Read(&magic, sizeof(magic)) || (magic != _RefGraphMagic) || !header.Read(&version, sizeof(version)) || (version != _RefGraphVersion) ||
+        !header.Read(&objectCount, sizeof(objectCount)) || !header.Read(&rootCount, sizeof(rootCount)))
+        return false;
+
+    // The objects follow the header and root indices, and each of them takes at least the size of its fixed fields, which bounds
+    // the counts of a corrupt archive before anything is allocated. Every object is also the target of at least one index.
+    const size_t headerSize = sizeof(magic) + sizeof(version) + sizeof(objectCount) + sizeof(rootCount);
+    if (rootCount > ((data.size() - headerSize) / sizeof(uint64_t)))
+        return false;
+
+    _RefGraphSizer<_Ty> sizer;
+    CreateScope<_Ty>()->Serialize(sizer);
+
+    const size_t objectBytes = data.size() - headerSize - (static_cast<size_t>(rootCount) * sizeof(uint64_t));
+    if ((objectCount > (data.size() / sizeof(uint64_t))) || (sizer.GetSize() && (objectCount > (objectBytes / sizer.GetSize()))))
+        return false;
+
+    objects = CreateRefs<_Ty>(objectCount);
+    _RefGraphReader<_Ty> reader(data, objects);
+    reader.Read(&magic, sizeof(magic));
+    reader.Read(&version, sizeof(version));
+    reader.Read(&objectCount, sizeof(objectCount));
+    reader.Read(&rootCount, sizeof(rootCount));
+
+    roots.resize(rootCount);
+    for (Ref<_Ty>& root : roots)
+        reader.Field(root);
+
+    for (const Ref<_Ty>& object : objects)
+    {
+        if (reader.Failed())
+            break;
+
+        object->Serialize(reader);
+    }
+
+    if (reader.Failed())
+    {
+        // Edges that were already connected may form cycles, which would keep the objects alive once they are dropped
+        _RefGraphUnlinker<_Ty> unlinker;
+        for (const Ref<_Ty>& object : objects)
+            object->Serialize(unlinker);
+
+        roots.clear();
+        return false;
+    }
+
+    return true;
+}
+
+class OffsetArena;
+
+// Pointer stored as the distance from its own address to the target, which stays valid wherever the memory holding both is
+// mapped. An offset of zero is null, so zero-filled memory holds null pointers.
+template<typename _Ty>
+class _OffsetPtr
+{
+protected:
+    constexpr _OffsetPtr() noexcept = default;
+    constexpr ~_OffsetPtr() noexcept = default;
+
+    _Ty* _Raw() const noexcept
+    {
+        return m_Offset ? reinterpret_cast<_Ty*>(reinterpret_cast<uintptr_t>(this) + static_cast<uintptr_t>(m_Offset)) : nullptr;
+    }
+
+    void _Set(const _Ty* ptr) noexcept
+    {
+        m_Offset = ptr ? static_cast<intptr_t>(reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(this)) : 0;
+    }
+
+private:
+    intptr_t m_Offset = 0;
+};
+
+// Reference count stored in front of every object created by OffsetArena::CreateRef
+struct _OffsetRefHeader
+{
+    // Immortal objects are never counted, so Refs to them never write to the memory they live in
+    static constexpr uint32_t s_Immortal = UINT32_MAX;
+
+    std::atomic_uint32_t Count;
+};
+
+// Unique owner of an object created by OffsetArena::CreateScope, stored as a self-relative offset.
+// The storage belongs to the arena, so releasing the object only runs its destructor.
+template<typename _Ty>
+class OffsetScope : public _OffsetPtr<_Ty>
+{
+public:
+    OffsetScope(OffsetScope<_Ty>&& other) noexcept { this->_Set(other.Release()); }
+    OffsetScope(const OffsetScope<_Ty>&) = delete;
+    OffsetScope(std::nullptr_t) noexcept { };
+    OffsetScope() noexcept = default;
+
+    ~OffsetScope() noexcept
+    {
+        Reset();
+    }
+
+    void Reset() noexcept
+    {
+        if (_Ty* ptr = Release())
+            ptr->~_Ty();
+    }
+
+    _Ty* Release() noexcept
+    {
+        _Ty* res = Raw();
+        this->_Set(nullptr);
+
+        return res;
+    }
+
+    _Ty* Raw() const noexcept
+    {
+        return this->_Raw();
+    }
+
+    bool Valid() const noexcept
+    {
+        return Raw() != nullptr;
+    }
+
+    explicit operator bool() const noexcept { return Valid(); }
+
+    OffsetScope<_Ty>& operator=(const OffsetScope<_Ty>&) = delete;
+
+    OffsetScope<_Ty>& operator=(OffsetScope<_Ty>&& other) noexcept
+    {
+        if (this != &other)
+        {
+            _Ty* ptr = other.Release();
+            Reset();
+            this->_Set(ptr);
+        }
+
+        return *this;
+    }
+
+    OffsetScope<_Ty>& operator=(std::nullptr_t) noexcept
+    {
+        Reset();
+        return *this;
+    }
+
+    _Ty* operator->() const noexcept { return Raw(); }
+    _Ty& operator*() const noexcept { return *Raw(); }
+
+private:
+    friend class OffsetArena;
+};
+
+// Reference counted pointer to an object created by OffsetArena::CreateRef, stored as a self-relative offset.
+// The count lives in the arena in front of the object. The storage belongs to the arena, so the final release only runs the
+// destructor. Objects created by an immortal arena are never counted or destroyed, which lets a read-only mapping of the arena
+// be used directly.
+template<typename _Ty>
+class OffsetRef : public _OffsetPtr<_Ty>
+{
+public:
+    OffsetRef(const OffsetRef<_Ty>& other) noexcept
+    {
+        this->_Set(other.Raw());
+        _IncRef();
+    }
+
+    OffsetRef(OffsetRef<_Ty>&& other) noexcept
+    {
+        this->_Set(other.Raw());
+        other._Set(nullptr);
+    }
+
+    OffsetRef(std::nullptr_t) noexcept { };
+    OffsetRef() noexcept = default;
+
+    ~OffsetRef() noexcept
+    {
+        _DecRef();
+    }
+
+    void Reset() noexcept
+    {
+        _DecRef();
+    }
+
+    // Returns 0 for null and UINT32_MAX for immortal objects
+    uint32_t RefCount() const noexcept
+    {
+        _OffsetRefHeader* header = _Header();
+        return header ? header->Count.load(std::memory_order_relaxed) : 0;
+    }
+
+    bool Immortal() const noexcept
+    {
+        return RefCount() == _OffsetRefHeader::s_Immortal;
+    }
+
+    _Ty* Raw() const noexcept
+    {
+        return this->_Raw();
+    }
+
+    bool Valid() const noexcept
+    {
+        return Raw() != nullptr;
+    }
+
+    explicit operator bool() const noexcept { return Valid(); }
+
+    OffsetRef<_Ty>& operator=(const OffsetRef<_Ty>& other) noexcept
+    {
+        // other may live inside the object released here, so it is read and retained first
+        _Ty* ptr = other.Raw();
+        if (ptr != Raw())
+        {
+            other._IncRef();
+            _DecRef();
+            this->_Set(ptr);
+        }
+
+        return *this;
+    }
+
+    OffsetRef<_Ty>& operator=(OffsetRef<_Ty>&& other) noexcept
+    {
+        if (this != &other)
+        {
+            _Ty* ptr = other.Raw();
+            other._Set(nullptr);
+            _DecRef();
+            this->_Set(ptr);
+        }
+
+        return *this;
+    }
+
+    OffsetRef<_Ty>& operator=(std::nullptr_t) noexcept
+    {
+        _DecRef();
+        return *this;
+    }
+
+    _Ty* operator->() const noexcept { return Raw(); }
+    _Ty& operator*() const noexcept { return *Raw(); }
+
+private:
+    static constexpr size_t _HeaderOffset() noexcept
+    {
+        return (sizeof(_OffsetRefHeader) + alignof(_Ty) - 1) & ~(alignof(_Ty) - 1);
+    }
+
+    _OffsetRefHeader* _Header() const noexcept
+    {
+        _Ty* ptr = Raw();
+        return ptr ? reinterpret_cast<_OffsetRefHeader*>(reinterpret_cast<std::byte*>(ptr) - _HeaderOffset()) : nullptr;
+    }
+
+    void _IncRef() const noexcept
+    {
+        _OffsetRefHeader* header = _Header();
+        if (header && (header->Count.load(std::memory_order_relaxed) != _OffsetRefHeader::s_Immortal))
+            header->Count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void _DecRef() noexcept
+    {
+        _OffsetRefHeader* header = _Header();
+        if (!header)
+            return;
+
+        _Ty* ptr = Raw();
+        this->_Set(nullptr);
+
+        if ((header->Count.load(std::memory_order_relaxed) != _OffsetRefHeader::s_Immortal) && (header->Count.fetch_sub(1, std::memory_order_acq_rel) == 1))
+            ptr->~_Ty();
+    }
+
+private:
+    friend class OffsetArena;
+};
+
+// Bump allocator building position-independent objects inside a caller-provided region, such as a writable file mapping.
+// Objects placed in the region must only point at each other through OffsetRef, OffsetScope or offsets of their own.
+// Once written, the region can be mapped anywhere, in any process, and its objects used without deserialization.
+// An immortal arena creates objects whose counts are never touched, as required for regions that will be mapped read-only.
+class OffsetArena
+{
+public:
+    OffsetArena(std::span<std::byte> region, bool immortal = false) noexcept : m_Region(region), m_Immortal(immortal) { };
+
+    // Returns nullptr if the region is full
+    template<typename _Ty, typename... _Args>
+    _Ty* Create(_Args&&... args) noexcept
+    {
+        void* storage = _Allocate(sizeof(_Ty), alignof(_Ty));
+        return storage ? ::new (storage) _Ty(std::forward<_Args>(args)...) : nullptr;
+    }
+
+    template<typename _Ty, typename... _Args>
+    OffsetScope<_Ty> CreateScope(_Args&&... args) noexcept
+    {
+        OffsetScope<_Ty> res;
+        res._Set(Create<_Ty>(std::forward<_Args>(args)...));
+
+        return res;
+    }
+
+    template<typename _Ty, typename... _Args>
+    OffsetRef<_Ty> CreateRef(_Args&&... args) noexcept
+    {
+        constexpr size_t headerOffset = OffsetRef<_Ty>::_HeaderOffset();
+        std::byte* storage = static_cast<std::byte*>(_Allocate(headerOffset + sizeof(_Ty), std::max(alignof(_Ty), alignof(_OffsetRefHeader))));
+
+        OffsetRef<_Ty> res;
+        if (storage)
+        {
+            ::new (storage) _OffsetRefHeader{ m_Immortal ? _OffsetRefHeader::s_Immortal : 1 };
+            res._Set(::new (storage + headerOffset) _Ty(std::forward<_Args>(args)...));
+        }
+
+        return res;
+    }
+
+    // The object at offset bytes from the start of the region. Offsets are relative to the start of the arena, not to any object:
+    // an object made by CreateRef() sits after its count, and even the first one made by Create() is only at 0 if the region is
+    // aligned for it. Record a root's offset while building the region, e.g. 'size_t rootOffset = arena.OffsetOf(root.Raw());'
+    // for an OffsetRef or 'arena.OffsetOf(root)' for a pointer from Create(), and store it alongside the region.
+    template<typename _Ty>
+    static _Ty* At(std::span<std::byte> region, size_t offset = 0) noexcept
+    {
+        return reinterpret_cast<_Ty*>(region.data() + offset);
+    }
+
+    size_t OffsetOf(const void* ptr) const noexcept
+    {
+        return static_cast<size_t>(static_cast<const std::byte*>(ptr) - m_Region.data());
+    }
+
+    size_t Used() const noexcept
+    {
+        return m_Used;
+    }
+
+    bool Immortal() const noexcept
+    {
+        return m_Immortal;
+    }
+
+private:
+    void* _Allocate(size_t size, size_t alignment) noexcept
+    {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(m_Region.data());
+        const uintptr_t start = (base + m_Used + alignment - 1) & ~(alignment - 1);
+        if ((start - base + size) > m_Region.size())
+            return nullptr;
+
+        m_Used = (start - base) + size;
+        return reinterpret_cast<void*>(start);
+    }
+
+private:
+    std::span<std::byte> m_Region;
+    size_t m_Used = 0;
+    bool m_Immortal;
+};
+
+#ifdef _INTRICATE_POSIX
+inline constexpr uint32_t _SharedHeapMagic = 0x50485349;    // "ISHP"
+inline constexpr uint32_t _SharedHeapBlockMagic = 0x4B4C4249;   // "IBLK"
+inline constexpr uint32_t _SharedHeapMaxProcesses = 64;
+inline constexpr size_t _SharedHeapAlignment = 16;
+
+// Header in front of every allocation of a SharedHeap. Blocks tile the heap from its start to its top, free or not.
+struct _SharedHeapBlock
+{
+    uint64_t Size;                      // Including this header
+    uint64_t NextFree;                  // Offset of the next free block while this one is free
+    std::atomic_uint64_t Holders;       // One bit for each process slot holding Refs to the object
+    uint16_t Allocated;
+    uint16_t Generation;                // Bumped each time the block is allocated, never 0 once it has been
+    uint32_t Magic;                     // Tells a block start from an offset into an object
+};
+
+struct _SharedHeapHeader
+{
+    uint32_t Magic;
+    std::atomic_uint32_t Initialized;
+    uint64_t Size;
+    uint64_t Top;
+    uint64_t FreeList;
+    std::atomic_uint64_t Root;
+    pthread_mutex_t Lock;               // Process-shared and robust, guards Top, FreeList and the Allocated flags
+    std::atomic_int32_t Pids[_SharedHeapMaxProcesses];
+};
+
+struct SharedHeapStats
+{
+    uint64_t Capacity = 0;
+    uint64_t UsedBytes = 0;
+    uint64_t LiveObjects = 0;
+    uint64_t FreeBlocks = 0;
+    uint32_t Processes = 0;
+};
+
+// A heap in a named POSIX shared memory segment whose objects are shared by every process that opens it.
+// Each process claims one of 64 slots and every object records which slots hold it in a process-shared atomic mask, so the
+// reference counting across processes costs one atomic operation per process and object. Within a process, the Refs to an
+// object share an ordinary local control block, so copying them never touches the segment.
+// The object is freed once the last process drops it. RecoverDeadProcesses() releases the holdings of processes that died
+// without dropping them, and the lock guarding the allocator is a robust mutex, so a crash while holding it does not wedge the heap.
+// Objects are addressed across processes by the offset OffsetOf() returns and must therefore be position-independent and
+// trivially destructible, since the process that frees an object may not have its code mapped at the same address.
+// An offset carries the generation of its block in its upper 16 bits, so Acquire() rejects an offset to an object that has been
+// freed even once its block holds another object, until that block has been reused 65535 times.
+// Every Ref obtained from a SharedHeap must be released before the SharedHeap is destroyed.
+class SharedHeap
+{
+public:
+    // Opens the segment called name, creating it with size bytes if it does not exist yet.
+    // Leaves the heap invalid if the process that created the segment does not size and initialize it within s_CreatorTimeout.
+    SharedHeap(const char* name, size_t size) noexcept
+    {
+        bool created = true;
+        int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if ((fd == -1) && (errno == EEXIST))
+        {
+            created = false;
+            fd = shm_open(name, O_RDWR, 0600);
+        }
+
+        if (fd == -1)
+            return;
+
+        if (created && (ftruncate(fd, static_cast<off_t>(size)) == -1))
+        {
+            close(fd);
+            return;
+        }
+
+        // The creator may not have sized the segment yet
+        struct stat info{};
+        if (!_WaitForCreator([&] { return (fstat(fd, &info) != 0) || (info.st_size != 0); }))
+        {
+            close(fd);
+            return;
+        }
+
+        m_Size = static_cast<size_t>(info.st_size);
+        void* mapping = (m_Size > s_HeapStart) ? mmap(nullptr, m_Size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+        close(fd);
+
+        if (mapping == MAP_FAILED)
+            return;
+
+        m_Base = static_cast<std::byte*>(mapping);
+        if (created)
+            _Initialize();
+
+        if (!_WaitForCreator([this] { return _Header()->Initialized.load(std::memory_order_acquire) != 0; }) ||
+            (_Header()->Magic != _SharedHeapMagic) || !_ClaimSlot())
+        {
+            munmap(m_Base, m_Size);
+            m_Base = nullptr;
+        }
+    }
+
+    SharedHeap(const SharedHeap&) = delete;
+    SharedHeap& operator=(const SharedHeap&) = delete;
+
+    ~SharedHeap() noexcept
+    {
+        if (!m_Base)
+            return;
+
+        // Holdings of Refs that were never released would otherwise be attributed to the next process claiming this slot
+        _ReleaseSlot(m_Slot);
+        _Header()->Pids[m_Slot].store(0, std::memory_order_release);
+        munmap(m_Base, m_Size);
+    }
+
+    static void Unlink(const char* name) noexcept
+    {
+        shm_unlink(name);
+    }
+
+    bool Valid() const noexcept
+    {
+        return m_Base != nullptr;
+    }
+
+    explicit operator bool() const noexcept { return Valid(); }
+
+    // Returns nullptr if the heap is full
+    template<typename _Ty, typename... _Args>
+    Ref<_Ty> Create(_Args&&... args) noexcept
+    {
+        static_assert(std::is_trivially_destructible_v<_Ty>, "SharedHeap objects must be trivially destructible");
+        static_assert(alignof(_Ty) <= _SharedHeapAlignment, "SharedHeap objects must not be over-aligned");
+
+        uint64_t blockOffset = _Allocate(s_BlockHeaderSize + sizeof(_Ty));
+        if (!blockOffset)
+            return nullptr;
+
+        _Ty* object = ::new (m_Base + blockOffset + s_BlockHeaderSize) _Ty(std::forward<_Args>(args)...);
+        const uint64_t offset = OffsetOf(object);
+
+        std::lock_guard<std::mutex> lock(m_LocalMutex);
+        _SharedRefCount<_Ty>* refCount = new _SharedRefCount<_Ty>(this, offset);
+        m_Local[offset] = refCount;
+
+        return _RefAccess::Adopt(object, static_cast<_RefCountType<_Ty>*>(refCount));
+    }
+
+    // Returns a Ref to the object at an offset from OffsetOf(), or nullptr if every process has dropped it.
+    // Offsets that do not point at the start of an allocated object of the generation they were taken from also return nullptr.
+    template<typename _Ty>
+    Ref<_Ty> Acquire(uint64_t offset) noexcept
+    {
+        const uint64_t objectOffset = offset & s_ObjectOffsetMask;
+        if ((objectOffset < (s_HeapStart + s_BlockHeaderSize)) || (objectOffset >= m_Size))
+            return nullptr;
+
+        _Ty* object = reinterpret_cast<_Ty*>(m_Base + objectOffset);
+
+        // Keyed by the whole offset, so an offset of an earlier generation never finds the Refs to the current object
+        std::lock_guard<std::mutex> lock(m_LocalMutex);
+        _AtomicStrongRefCount*& local = m_Local[offset];
+        if (local && local->TryIncRef())
+            return _RefAccess::Adopt(object, static_cast<_RefCountType<_Ty>*>(local));
+
+        // A stale local block is replaced, its pending release sees the replacement and keeps this process's bit
+        if (!_Hold(objectOffset - s_BlockHeaderSize, static_cast<uint16_t>(offset >> s_GenerationShift), sizeof(_Ty)))
+        {
+            if (!local)
+                m_Local.erase(offset);
+
+            return nullptr;
+        }
+
+        _SharedRefCount<_Ty>* refCount = new _SharedRefCount<_Ty>(this, offset);
+        local = refCount;
+
+        return _RefAccess::Adopt(object, static_cast<_RefCountType<_Ty>*>(refCount));
+    }
+
+    // The offset of an object this process holds a Ref to, tagged with the generation of its block
+    uint64_t OffsetOf(const void* object) const noexcept
+    {
+        const uint64_t objectOffset = static_cast<uint64_t>(static_cast<const std::byte*>(object) - m_Base);
+        return objectOffset | (static_cast<uint64_t>(_BlockAt(objectOffset - s_BlockHeaderSize)->Generation) << s_GenerationShift);
+    }
+
+    // A single offset published for other processes to find, typically the object that leads to the rest
+    void SetRoot(uint64_t offset) noexcept
+    {
+        _Header()->Root.store(offset, std::memory_order_release);
+    }
+
+    uint64_t GetRoot() const noexcept
+    {
+        return _Header()->Root.load(std::memory_order_acquire);
+    }
+
+    // Releases the holdings of every process that exited without releasing them, returns how many such processes were found
+    uint32_t RecoverDeadProcesses() noexcept
+    {
+        uint32_t recovered = 0;
+        for (uint32_t slot = 0; slot < _SharedHeapMaxProcesses; ++slot)
+        {
+            const int32_t pid = _Header()->Pids[slot].load(std::memory_order_acquire);
+            if ((pid <= 0) || (slot == m_Slot) || (kill(pid, 0) == 0) || (errno != ESRCH))
+                continue;
+
+            // Claimed with a compare-exchange so that concurrent recoveries handle each dead process once
+            int32_t expected = pid;
+            if (!_Header()->Pids[slot].compare_exchange_strong(expected, -pid, std::memory_order_acq_rel))
+                continue;
+
+            _ReleaseSlot(slot);
+            _Header()->Pids[slot].store(0, std::memory_order_release);
+            ++recovered;
+        }
+
+        return recovered;
+    }
+
+    SharedHeapStats GetStats() const noexcept
+    {
+        SharedHeapStats res;
+        res.Capacity = m_Size - s_HeapStart;
+
+        for (uint32_t slot = 0; slot < _SharedHeapMaxProcesses; ++slot)
+            res.Processes += (_Header()->Pids[slot].load(std::memory_order_relaxed) > 0);
+
+        _Lock();
+        res.UsedBytes = _Header()->Top - s_HeapStart;
+        for (uint64_t offset = s_HeapStart; offset < _Header()->Top; offset += _BlockAt(offset)->Size)
+        {
+            if (_BlockAt(offset)->Allocated)
+                ++res.LiveObjects;
+            else
+                ++res.FreeBlocks;
+        }
+        _Unlock();
+
+        return res;
+    }
+
+private:
+    // Local control block standing for this process's hold on a shared object
+    template<typename _Ty>
+    class _SharedRefCount : public _RefCountType<_Ty>
+    {
+    public:
+        _SharedRefCount(SharedHeap* heap, uint64_t offset) noexcept : _RefCountType<_Ty>(&s_Ops), m_Heap(heap), m_Offset(offset) { };
+
+    private:
+        static void _Destroy(_AtomicStrongRefCount* refCount) noexcept
+        {
+            _SharedRefCount* self = static_cast<_SharedRefCount*>(refCount);
+            self->m_Heap->_ReleaseLocal(self, self->m_Offset);
+        }
+
+        static void _Free(_AtomicStrongRefCount* refCount) noexcept
+        {
+            delete static_cast<_SharedRefCount*>(refCount);
+        }
+
+        static void* _GetObject(const _AtomicStrongRefCount* refCount) noexcept
+        {
+            const _SharedRefCount* self = static_cast<const _SharedRefCount*>(refCount);
+            return self->m_Heap->m_Base + (self->m_Offset & s_ObjectOffsetMask);
+        }
+
+    private:
+        static constexpr _RefCountOps s_Ops{ &_Destroy, &_Free, &_GetObject, false };
+
+        SharedHeap* m_Heap;
+        uint64_t m_Offset;      // As returned by OffsetOf()
+    };
+
+    static constexpr uint64_t _AlignUp(uint64_t value, uint64_t alignment) noexcept
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    static constexpr uint64_t s_HeapStart = (sizeof(_SharedHeapHeader) + 63) & ~uint64_t(63);
+    static constexpr uint64_t s_BlockHeaderSize = (sizeof(_SharedHeapBlock) + _SharedHeapAlignment - 1) & ~uint64_t(_SharedHeapAlignment - 1);
+    static constexpr uint32_t s_GenerationShift = 48;
+    static constexpr uint64_t s_ObjectOffsetMask = (uint64_t(1) << s_GenerationShift) - 1;
+
+    static constexpr uint16_t _NextGeneration(uint16_t generation) noexcept
+    {
+        return (generation == UINT16_MAX) ? 1 : static_cast<uint16_t>(generation + 1);
+    }
+
+    static constexpr uint64_t _SlotBit(uint32_t slot) noexcept
+    {
+        return uint64_t(1) << slot;
+    }
+
+    // How long an opening process waits for the creator of the segment, which has died if it takes longer
+    static constexpr std::chrono::milliseconds s_CreatorTimeout{ 1000 };
+
+    template<typename _Pred>
+    static bool _WaitForCreator(_Pred&& ready) noexcept
+    {
+        const auto deadline = std::chrono::steady_clock::now() + s_CreatorTimeout;
+        while (!ready())
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+                return false;
+
+            std::this_thread::yield();
+        }
+
+        return true;
+    }
+
+    _SharedHeapHeader* _Header() const noexcept
+    {
+        return reinterpret_cast<_SharedHeapHeader*>(m_Base);
+    }
+
+    _SharedHeapBlock* _BlockAt(uint64_t offset) const noexcept
+    {
+        return reinterpret_cast<_SharedHeapBlock*>(m_Base + offset);
+    }
+
+    void _Initialize() noexcept
+    {
+        _SharedHeapHeader* header = ::new (m_Base) _SharedHeapHeader{};
+        header->Magic = _SharedHeapMagic;
+        header->Size = m_Size;
+        header->Top = s_HeapStart;
+        header->FreeList = 0;
+
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header->Lock, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+
+        header->Initialized.store(1, std::memory_order_release);
+    }
+
+    bool _ClaimSlot() noexcept
+    {
+        const int32_t pid = static_cast<int32_t>(getpid());
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            for (uint32_t slot = 0; slot < _SharedHeapMaxProcesses; ++slot)
+            {
+                int32_t expected = 0;
+                if (_Header()->Pids[slot].compare_exchange_strong(expected, pid, std::memory_order_acq_rel))
+                {
+                    m_Slot = slot;
+                    return true;
+                }
+            }
+
+            // Every slot is taken, reclaim the ones of dead processes once
+            m_Slot = _SharedHeapMaxProcesses;
+            RecoverDeadProcesses();
+        }
+
+        return false;
+    }
+
+    void _Lock() const noexcept
+    {
+        // The previous owner died holding the lock. Every block header is complete before Top covers it and a block leaves the
+        // free list before it is marked allocated, so at worst the block being allocated is leaked, keep going.
+        if (pthread_mutex_lock(&_Header()->Lock) == EOWNERDEAD)
+            pthread_mutex_consistent(&_Header()->Lock);
+    }
+
+    void _Unlock() const noexcept
+    {
+        pthread_mutex_unlock(&_Header()->Lock);
+    }
+
+    // The block is returned held by this process, so that RecoverDeadProcesses() can free it if this process dies before
+    // handing it to a Ref
+    uint64_t _Allocate(uint64_t size) noexcept
+    {
+        size = _AlignUp(size, _SharedHeapAlignment);
+        _Lock();
+
+        // First fit over the free blocks, which are reused whole so that the blocks keep tiling the heap
+        uint64_t* link = &_Header()->FreeList;
+        while (*link && (_BlockAt(*link)->Size < size))
+            link = &_BlockAt(*link)->NextFree;
+
+        uint64_t offset = *link;
+        if (offset)
+        {
+            // Holders are ignored while the block is not allocated
+            _SharedHeapBlock* block = _BlockAt(offset);
+            block->Holders.store(_SlotBit(m_Slot), std::memory_order_relaxed);
+            block->Generation = _NextGeneration(block->Generation);
+            *link = block->NextFree;
+        }
+        else if ((_Header()->Top + size) <= m_Size)
+        {
+            // The header is written before Top covers it, so the walks over the blocks never see one without its size
+            offset = _Header()->Top;
+            ::new (_BlockAt(offset)) _SharedHeapBlock{ size, 0, { _SlotBit(m_Slot) }, 0, 1, _SharedHeapBlockMagic };
+            _Header()->Top += size;
+        }
+
+        if (offset)
+            _BlockAt(offset)->Allocated = 1;
+
+        _Unlock();
+        return offset;
+    }
+
+    void _FreeLocked(uint64_t offset) noexcept
+    {
+        _SharedHeapBlock* block = _BlockAt(offset);
+        block->Allocated = 0;
+        block->NextFree = _Header()->FreeList;
+        _Header()->FreeList = offset;
+    }
+
+    // Adds this process to the holders of the block at blockOffset after checking, under the lock that guards allocation, that it
+    // is the start of an allocated block of the given generation large enough for an object of objectSize bytes
+    bool _Hold(uint64_t blockOffset, uint16_t generation, size_t objectSize) noexcept
+    {
+        _Lock();
+
+        _SharedHeapBlock* block = _BlockAt(blockOffset);
+        bool held = ((blockOffset % _SharedHeapAlignment) == 0) && ((blockOffset + s_BlockHeaderSize) <= _Header()->Top) &&
+            (block->Magic == _SharedHeapBlockMagic) && block->Allocated && (block->Generation == generation) &&
+            ((s_BlockHeaderSize + objectSize) <= block->Size);
+
+        // Holders drop their bits without the lock, a block whose last holder has left is about to be freed
+        if (held)
+        {
+            uint64_t holders = block->Holders.load(std::memory_order_relaxed);
+            while ((holders != 0) && !block->Holders.compare_exchange_weak(holders, holders | _SlotBit(m_Slot), std::memory_order_acquire, std::memory_order_relaxed)) { }
+
+            held = (holders != 0);
+        }
+
+        _Unlock();
+
+        return held;
+    }
+
+    // Clears bits from the holders of a block, the caller that clears the last bit frees it
+    bool _DropHolders(uint64_t offset, uint64_t bits) noexcept
+    {
+        const uint64_t previous = _BlockAt(offset)->Holders.fetch_and(~bits, std::memory_order_acq_rel);
+        return (previous & bits) && !(previous & ~bits);
+    }
+
+    void _ReleaseLocal(_AtomicStrongRefCount* refCount, uint64_t offset) noexcept
+    {
+        const uint64_t blockOffset = (offset & s_ObjectOffsetMask) - s_BlockHeaderSize;
+        {
+            std::lock_guard<std::mutex> lock(m_LocalMutex);
+            auto it = m_Local.find(offset);
+            if ((it == m_Local.end()) || (it->second != refCount))
+                return;
+
+            m_Local.erase(it);
+            if (!_DropHolders(blockOffset, _SlotBit(m_Slot)))
+                return;
+        }
+
+        _Lock();
+        _FreeLocked(blockOffset);
+        _Unlock();
+    }
+
+    void _ReleaseSlot(uint32_t slot) noexcept
+    {
+        _Lock();
+        for (uint64_t offset = s_HeapStart; offset < _Header()->Top; offset += _BlockAt(offset)->Size)
+        {
+            if (_BlockAt(offset)->Allocated && _DropHolders(offset, _SlotBit(slot)))
+                _FreeLocked(offset);
+        }
+        _Unlock();
+    }
+
+private:
+    std::byte* m_Base = nullptr;
+    size_t m_Size = 0;
+    uint32_t m_Slot = _SharedHeapMaxProcesses;
+    std::mutex m_LocalMutex;
+    std::unordered_map<uint64_t, _AtomicStrongRefCount*> m_Local;   // Live local control block of each object held by this process, by offset
+};
+#endif // _INTRICATE_POSIX
+
+#ifdef _INTRICATE_POSIX
+// Hints passed to madvise() for a new mapping, combined with operator|
+enum class MappedAdvice : uint32_t
+{
+    Normal = 0,
+    Sequential = 1 << 0,
+    Random = 1 << 1,
+    WillNeed = 1 << 2
+};
+
+constexpr MappedAdvice operator|(MappedAdvice lhs, MappedAdvice rhs) noexcept
+{
+    return static_cast<MappedAdvice>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+}
+
+constexpr bool _HasAdvice(MappedAdvice advice, MappedAdvice flag) noexcept
+{
+    return (static_cast<uint32_t>(advice) & static_cast<uint32_t>(flag)) != 0;
+}
+
+// Control block of a file mapping, unmapping it once the last slice into it is released
+class _MappedRegion : public _RefCountType<const std::byte>
+{
+public:
+    _MappedRegion(void* base, size_t length) noexcept : _RefCountType<const std::byte>(&s_Ops), m_Base(base), m_Length(length) { };
+
+private:
+    static void _Destroy(_AtomicStrongRefCount* refCount) noexcept
+    {
+        _MappedRegion* self = static_cast<_MappedRegion*>(refCount);
+        (void)::munmap(self->m_Base, self->m_Length);
+    }
+
+    static void _Free(_AtomicStrongRefCount* refCount) noexcept
+    {
+        delete static_cast<_MappedRegion*>(refCount);
+    }
+
+    static void* _GetObject(const _AtomicStrongRefCount* refCount) noexcept
+    {
+        return static_cast<const _MappedRegion*>(refCount)->m_Base;
+    }
+
+private:
+    static constexpr _RefCountOps s_Ops{ &_Destroy, &_Free, &_GetObject, false };
+
+    void* m_Base;
+    size_t m_Length;
+};
+
+// Read-only view into a mapped file range. A slice is a Ref aliasing into the mapping, so its sub-slices share the count of the
+// mapping and can be passed between stages without copying bytes. The range is unmapped once the last slice into it is released.
+class MappedSlice
+{
+public:
+    constexpr MappedSlice(std::nullptr_t) noexcept { };
+    constexpr MappedSlice() noexcept = default;
+
+    // Sub-range of this slice, clamped to its end
+    MappedSlice Slice(size_t offset, size_t length = SIZE_MAX) const& noexcept
+    {
+        offset = std::min(offset, m_Size);
+        return MappedSlice(Ref<const std::byte>(m_Data, m_Data.Raw() + offset), std::min(length, m_Size - offset));
+    }
+
+    MappedSlice Slice(size_t offset, size_t length = SIZE_MAX) && noexcept
+    {
+        offset = std::min(offset, m_Size);
+        const std::byte* data = m_Data.Raw() + offset;
+        return MappedSlice(Ref<const std::byte>(std::move(m_Data), data), std::min(length, m_Size - offset));
+    }
+
+    const std::byte* Data() const noexcept
+    {
+        return m_Data.Raw();
+    }
+
+    size_t Size() const noexcept
+    {
+        return m_Size;
+    }
+
+    bool Empty() const noexcept
+    {
+        return m_Size == 0;
+    }
+
+    std::span<const std::byte> Span() const noexcept
+    {
+        return { Data(), m_Size };
+    }
+
+    std::string_view View() const noexcept
+    {
+        return { reinterpret_cast<const char*>(Data()), m_Size };
+    }
+
+    // The Ref keeping the mapping alive, for storing the slice in Ref-based containers
+    const Ref<const std::byte>& GetRef() const noexcept
+    {
+        return m_Data;
+    }
+
+    uint32_t RefCount() const noexcept
+    {
+        return m_Data.RefCount();
+    }
+
+    void Reset() noexcept
+    {
+        m_Data.Reset();
+        m_Size = 0;
+    }
+
+    bool Valid() const noexcept
+    {
+        return m_Data.Valid();
+    }
+
+    explicit operator bool() const noexcept { return Valid(); }
+
+private:
+    MappedSlice(Ref<const std::byte>&& data, size_t size) noexcept : m_Data(std::move(data)), m_Size(size) { };
+
+private:
+    Ref<const std::byte> m_Data;
+    size_t m_Size = 0;
+
+    friend class MappedFile;
+};
+
+// A file opened for mapping ranges of it as MappedSlices. Mappings outlive the MappedFile they came from.
+// The file may keep growing while it is open, as a log does: Map() looks up the current size whenever a range reaches past the
+// last known one, and Refresh() updates Size().
+class MappedFile
+{
+public:
+    explicit MappedFile(const char* path) noexcept : m_File(::open(path, O_RDONLY | O_CLOEXEC))
+    {
+        (void)Refresh();
+    }
+
+    MappedFile(MappedFile&& other) noexcept : m_File(std::exchange(other.m_File, -1)), m_Size(std::exchange(other.m_Size, 0)) { };
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() noexcept
+    {
+        if (m_File != -1)
+            (void)::close(m_File);
+    }
+
+    // Reads the current size of the file, which is returned and kept as Size()
+    uint64_t Refresh() noexcept
+    {
+        m_Size = _CurrentSize();
+        return m_Size;
+    }
+
+    // Maps length bytes starting at offset, clamped to the end of the file. Returns nullptr for an empty range or on failure.
+    MappedSlice Map(uint64_t offset = 0, size_t length = SIZE_MAX, MappedAdvice advice = MappedAdvice::Sequential | MappedAdvice::WillNeed) const noexcept
+    {
+        if (!Valid())
+            return nullptr;
+
+        // Only a range reaching past the last known end needs the current size
+        uint64_t size = m_Size;
+        if ((offset >= size) || (length > (size - offset)))
+            size = _CurrentSize();
+
+        if (offset >= size)
+            return nullptr;
+
+        length = static_cast<size_t>(std::min<uint64_t>(length, size - offset));
+
+        // mmap() only takes page-aligned offsets, the slice skips the head of the first page
+        const uint64_t pageOffset = offset % static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+        const size_t mappedLength = length + static_cast<size_t>(pageOffset);
+        void* base = ::mmap(nullptr, mappedLength, PROT_READ, MAP_PRIVATE, m_File, static_cast<off_t>(offset - pageOffset));
+        if (base == MAP_FAILED)
+            return nullptr;
+
+        if (_HasAdvice(advice, MappedAdvice::Sequential))
+            (void)::madvise(base, mappedLength, MADV_SEQUENTIAL);
+        else if (_HasAdvice(advice, MappedAdvice::Random))
+            (void)::madvise(base, mappedLength, MADV_RANDOM);
+
+        if (_HasAdvice(advice, MappedAdvice::WillNeed))
+            (void)::madvise(base, mappedLength, MADV_WILLNEED);
+
+        const std::byte* bytes = static_cast<const std::byte*>(base);
+        Ref<const std::byte> mapping = _RefAccess::Adopt(bytes, static_cast<_RefCountType<const std::byte>*>(new _MappedRegion(base, mappedLength)));
+
+        return MappedSlice(Ref<const std::byte>(std::move(mapping), bytes + pageOffset), length);
+    }
+
+    static MappedSlice MapFile(const char* path, MappedAdvice advice = MappedAdvice::Sequential | MappedAdvice::WillNeed) noexcept
+    {
+        return MappedFile(path).Map(0, SIZE_MAX, advice);
+    }
+
+    uint64_t Size() const noexcept
+    {
+        return m_Size;
+    }
+
+    bool Valid() const noexcept
+    {
+        return m_File != -1;
+    }
+
+    explicit operator bool() const noexcept { return Valid(); }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_File != -1)
+                (void)::close(m_File);
+
+            m_File = std::exchange(other.m_File, -1);
+            m_Size = std::exchange(other.m_Size, 0);
+        }
+
+        return *this;
+    }
+
+private:
+    uint64_t _CurrentSize() const noexcept
+    {
+        struct stat info{};
+        return ((m_File != -1) && (::fstat(m_File, &info) == 0)) ? static_cast<uint64_t>(info.st_size) : 0;
+    }
+
+private:
+    int m_File = -1;
+    uint64_t m_Size = 0;
+};
+#endif // _INTRICATE_POSIX
+
+// Control block of a RefBuffer, followed by the bytes of the buffer in the same allocation
+class _RefBufferBlock : public _RefCountType<std::byte>
+{
+public:
+    static _RefBufferBlock* Allocate(size_t capacity) noexcept
+    {
+        void* memory = ::operator new(_HeaderSize() + capacity, std::nothrow);
+        if (!memory)
+            std::terminate();
+
+        return ::new (memory) _RefBufferBlock(capacity);
+    }
+
+    std::byte* Bytes() noexcept
+    {
+        return reinterpret_cast<std::byte*>(this) + _HeaderSize();
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return m_Capacity;
+    }
+
+private:
+    explicit _RefBufferBlock(size_t capacity) noexcept : _RefCountType<std::byte>(&s_Ops), m_Capacity(capacity) { };
+
+    static constexpr size_t _HeaderSize() noexcept
+    {
+        return (sizeof(_RefBufferBlock) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    }
+
+    // The bytes need no destruction and are released together with the block
+    static void _Destroy(_AtomicStrongRefCount*) noexcept { }
+
+    static void _Free(_AtomicStrongRefCount* refCount) noexcept
+    {
+        _RefBufferBlock* block = static_cast<_RefBufferBlock*>(refCount);
+        block->~_RefBufferBlock();
+        ::operator delete(static_cast<void*>(block));
+    }
+
+    static void* _GetObject(const _AtomicStrongRefCount* refCount) noexcept
+    {
+        return const_cast<_RefBufferBlock*>(static_cast<const _RefBufferBlock*>(refCount))->Bytes();
+    }
+
+private:
+    static constexpr _RefCountOps s_Ops{ &_Destroy, &_Free, &_GetObject, false };
+
+    size_t m_Capacity;
+};
+
+// Reference-counted byte buffer whose count and bytes share a single allocation.
+// A RefBuffer is a view into its allocation, so Slice() hands out sub-ranges sharing the count without copying. While a view is
+// the only reference to its allocation, Append() and Prepend() write into the free room around it in place, and only copy
+// into a new allocation when the bytes are shared or the room has run out.
+class RefBuffer
+{
+public:
+    constexpr RefBuffer(std::nullptr_t) noexcept { };
+    constexpr RefBuffer() noexcept = default;
+
+    // An empty buffer with room for capacity bytes, the first headroom of which are kept free for Prepend()
+    static RefBuffer Create(size_t capacity, size_t headroom = 0) noexcept
+    {
+        _RefBufferBlock* block = _RefBufferBlock::Allocate(std::max(capacity, headroom));
+        return RefBuffer(_RefAccess::Adopt(block->Bytes() + headroom, static_cast<_RefCountType<std::byte>*>(block)), 0);
+    }
+
+    static RefBuffer Copy(std::span<const std::byte> bytes, size_t tailroom = 0) noexcept
+    {
+        RefBuffer res = Create(bytes.size() + tailroom);
+        if (!bytes.empty())
+            std::memcpy(res.m_Data.Raw(), bytes.data(), bytes.size());
+
+        res.m_Size = bytes.size();
+        return res;
     }
 
-    void _DecWeakRef() noexcept
+    static RefBuffer Copy(std::string_view text, size_t tailroom = 0) noexcept
     {
-        if (m_RefCount && (m_RefCount->DecWeakRef() == 0) && (_RefCount() == 0))
-        {
-            delete m_RefCount;
-            m_RefCount = nullptr;
-        }
+        return Copy(std::as_bytes(std::span<const char>(text.data(), text.size())), tailroom);
     }
 
-    template<typename _Ty2>
-    constexpr void _ConstructFromRaw(_Ty2* ptr) noexcept
+    // Sub-range of this buffer, clamped to its end
+    RefBuffer Slice(size_t offset, size_t length = SIZE_MAX) const& noexcept
     {
-        m_Ptr = static_cast<_Ty*>(ptr);
-        m_RefCount = m_Ptr ? new _AtomicRefCount() : nullptr;
+        offset = std::min(offset, m_Size);
+        return RefBuffer(Ref<std::byte>(m_Data, m_Data.Raw() + offset), std::min(length, m_Size - offset));
     }
 
-    template<typename _Ty2>
-    constexpr void _MoveConstructFrom(_RefBase<_Ty2>&& ptr) noexcept
+    RefBuffer Slice(size_t offset, size_t length = SIZE_MAX) && noexcept
     {
-        m_Ptr = static_cast<_Ty*>(ptr.m_Ptr);
-        m_RefCount = ptr.m_RefCount;
-
-        ptr.m_Ptr = nullptr;
-        ptr.m_RefCount = nullptr;
+        offset = std::min(offset, m_Size);
+        std::byte* data = m_Data.Raw() + offset;
+        return RefBuffer(Ref<std::byte>(std::move(m_Data), data), std::min(length, m_Size - offset));
     }
 
-    template<typename _Ty2>
-    constexpr void _CopyConstructFrom(const Ref<_Ty2>& ref) noexcept
+    void Append(std::span<const std::byte> bytes) noexcept
     {
-        m_Ptr = static_cast<_Ty*>(ref.m_Ptr);
-        m_RefCount = ref.m_RefCount;
+        if (bytes.empty())
+            return;
 
-        _IncRef();
+        // bytes may point into this buffer, which has to outlive the copy
+        Ref<std::byte> previous;
+        if (!_CanWrite() || (Tailroom() < bytes.size()))
+        {
+            previous = m_Data;
+            _Reallocate(0, std::max(bytes.size(), m_Size));
+        }
+
+        std::memcpy(m_Data.Raw() + m_Size, bytes.data(), bytes.size());
+        m_Size += bytes.size();
     }
 
-    template<typename _Ty2>
-    constexpr void _WeaklyConstructFrom(const _RefBase<_Ty2>& ptr) noexcept
+    void Append(std::string_view text) noexcept
     {
-        m_Ptr = static_cast<_Ty*>(ptr.m_Ptr);
-        m_RefCount = ptr.m_RefCount;
-        _IncWeakRef();
+        Append(std::as_bytes(std::span<const char>(text.data(), text.size())));
     }
 
-    // TODO: Make this better
-    template<typename _Ty2>
-    constexpr void _ConstructFromWeak(const WeakRef<_Ty2>& weak) noexcept
+    void Prepend(std::span<const std::byte> bytes) noexcept
     {
-        m_Ptr = static_cast<_Ty*>(weak.m_Ptr);
-        m_RefCount = weak.m_RefCount;
+        if (bytes.empty())
+            return;
 
-        _IncRef();
-    }
+        Ref<std::byte> previous;
+        if (!_CanWrite() || (Headroom() < bytes.size()))
+        {
+            previous = m_Data;
+            _Reallocate(std::max(bytes.size(), m_Size), 0);
+        }
 
-private:
-    _Ty* m_Ptr = nullptr;
-    _AtomicRefCount* m_RefCount = nullptr;
+        std::byte* data = m_Data.Raw() - bytes.size();
+        m_Data = Ref<std::byte>(std::move(m_Data), data);
+        m_Size += bytes.size();
 
-private:
-    template<typename _Ty2>
-    friend class _RefBase;
+        std::memcpy(data, bytes.data(), bytes.size());
+    }
 
-    friend class Ref<_Ty>;
-    friend class WeakRef<_Ty>;
-};
+    void Prepend(std::string_view text) noexcept
+    {
+        Prepend(std::as_bytes(std::span<const char>(text.data(), text.size())));
+    }
 
-template<typename _Ty>
-class Ref : public _RefBase<_Ty>
-{
-public:
-    constexpr explicit Ref(_Ty* ptr) noexcept { this->_ConstructFromRaw(ptr); }
+    // Trimming only narrows this view, the bytes stay in place for the other references to them
+    void TrimStart(size_t count) noexcept
+    {
+        count = std::min(count, m_Size);
+        std::byte* data = m_Data.Raw() + count;
+        m_Data = Ref<std::byte>(std::move(m_Data), data);
+        m_Size -= count;
+    }
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr explicit Ref(_Ty2* ptr) noexcept { this->_ConstructFromRaw(ptr); }
+    void TrimEnd(size_t count) noexcept
+    {
+        m_Size -= std::min(count, m_Size);
+    }
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr Ref(const Ref<_Ty2>& other) noexcept { this->_CopyConstructFrom(other); }
+    // Room after the bytes to be written in place while this is the only reference to them, nullptr otherwise.
+    // Commit() then adds the bytes written there to the buffer.
+    std::byte* WritableTail() noexcept
+    {
+        return _CanWrite() ? m_Data.Raw() + m_Size : nullptr;
+    }
 
-    Ref(const Ref<_Ty>& other) noexcept { this->_CopyConstructFrom(other); }
+    void Commit(size_t count) noexcept
+    {
+        m_Size += std::min(count, Tailroom());
+    }
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr Ref(Ref<_Ty2>&& other) noexcept { this->_MoveConstructFrom(std::move(other)); }
+    // Makes sure tailroom bytes can be appended in place
+    void Reserve(size_t tailroom) noexcept
+    {
+        if (!_CanWrite() || (Tailroom() < tailroom))
+            _Reallocate(0, tailroom);
+    }
 
-    constexpr Ref(Ref<_Ty>&& other) noexcept { this->_MoveConstructFrom(std::move(other)); }
+    // Copies the bytes if they are shared so that they can be written to, and returns them
+    std::byte* Unshare() noexcept
+    {
+        if (!_CanWrite())
+            _Reallocate(0, 0);
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr explicit Ref(const WeakRef<_Ty2>& weak) noexcept { this->_ConstructFromWeak(weak); }
+        return m_Data.Raw();
+    }
 
-    constexpr explicit Ref(const WeakRef<_Ty>& weak) noexcept { this->_ConstructFromWeak(weak); }
+    size_t Headroom() const noexcept
+    {
+        _RefBufferBlock* block = _Block();
+        return block ? static_cast<size_t>(m_Data.Raw() - block->Bytes()) : 0;
+    }
 
-    constexpr Ref(std::nullptr_t) noexcept : _RefBase<_Ty>(nullptr) { };
-    constexpr Ref() noexcept = default;
-    constexpr ~Ref() noexcept { this->_DecRef(); }
+    size_t Tailroom() const noexcept
+    {
+        _RefBufferBlock* block = _Block();
+        return block ? block->Capacity() - Headroom() - m_Size : 0;
+    }
 
-    constexpr void Swap(Ref<_Ty>& other) noexcept
+    const std::byte* Data() const noexcept
     {
-        if (this != &other)
-            this->_Swap(other);
+        return m_Data.Raw();
     }
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr void Reset(_Ty2* newPtr) noexcept
+    size_t Size() const noexcept
     {
-        Ref<_Ty2>(newPtr).Swap(*this);
+        return m_Size;
     }
 
-    constexpr void Reset(_Ty* newPtr) noexcept
+    bool Empty() const noexcept
     {
-        Ref<_Ty>(newPtr).Swap(*this);
+        return m_Size == 0;
     }
 
-    constexpr void Reset() noexcept
+    std::span<const std::byte> Span() const noexcept
     {
-        Ref<_Ty>(nullptr).Swap(*this);
+        return { Data(), m_Size };
     }
 
-    constexpr _Ty* Release() noexcept
+    std::string_view View() const noexcept
     {
-        _Ty* res = std::exchange(this->m_Ptr, nullptr);
-        Ref<_Ty>(nullptr).Swap(*this);
+        return { reinterpret_cast<const char*>(Data()), m_Size };
+    }
 
-        return res;
+    // The Ref keeping the allocation alive, for storing the buffer in Ref-based containers
+    const Ref<std::byte>& GetRef() const noexcept
+    {
+        return m_Data;
     }
 
     uint32_t RefCount() const noexcept
     {
-        return this->_RefCount();
+        return m_Data.RefCount();
     }
 
     bool Unique() const noexcept
     {
-        return RefCount() == 1;
+        return m_Data.Unique();
     }
 
-    constexpr _Ty* Raw() const noexcept
+    void Reset() noexcept
     {
-        return this->_Raw();
+        m_Data.Reset();
+        m_Size = 0;
     }
 
-    constexpr bool Valid() const noexcept
+    bool Valid() const noexcept
     {
-        return Raw() != nullptr;
+        return m_Data.Valid();
     }
 
-    constexpr explicit operator bool() const noexcept { return Valid(); }
-    constexpr operator Ref<const _Ty>() const noexcept { return Ref<const _Ty>{ this->m_Ptr, this->m_RefCount, this->m_WeakRefCount }; }
+    explicit operator bool() const noexcept { return Valid(); }
 
-    Ref<_Ty>& operator=(const Ref<_Ty>& other) noexcept
-    {
-        Ref<_Ty>(other).Swap(*this);
-        return *this;
-    }
+private:
+    RefBuffer(Ref<std::byte>&& data, size_t size) noexcept : m_Data(std::move(data)), m_Size(size) { };
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr Ref<_Ty>& operator=(const Ref<_Ty2>& other) noexcept
+    _RefBufferBlock* _Block() const noexcept
     {
-        Ref<_Ty>(other).Swap(*this);
-        return *this;
+        return static_cast<_RefBufferBlock*>(_RefAccess::GetRefCount(m_Data));
     }
 
-    Ref<_Ty>& operator=(Ref<_Ty>&& other) noexcept
+    bool _CanWrite() const noexcept
     {
-        Ref<_Ty>(std::move(other)).Swap(*this);
-        return *this;
+        return m_Data.Valid() && m_Data.Unique();
     }
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr Ref<_Ty>& operator=(Ref<_Ty2>&& other) noexcept
+    // Moves the bytes into a new allocation of their own with the given room around them
+    void _Reallocate(size_t headroom, size_t tailroom) noexcept
     {
-        Ref<_Ty>(std::move(other)).Swap(*this);
-        return *this;
-    }
+        _RefBufferBlock* block = _RefBufferBlock::Allocate(headroom + m_Size + tailroom);
+        if (m_Size)
+            std::memcpy(block->Bytes() + headroom, m_Data.Raw(), m_Size);
 
-    constexpr Ref<_Ty>& operator=(std::nullptr_t) noexcept
-    {
-        Ref<_Ty>(nullptr).Swap(*this);
-        return *this;
+        m_Data = _RefAccess::Adopt(block->Bytes() + headroom, static_cast<_RefCountType<std::byte>*>(block));
     }
 
-    constexpr _Ty* operator->() const noexcept { return this->Raw(); }
-    constexpr _Ty& operator*() const noexcept { return *Raw(); }
-
 private:
-    template<typename _Ty2>
-    friend class Ref;
+    Ref<std::byte> m_Data;
+    size_t m_Size = 0;
 };
 
-template<typename _Ty, typename... _Args, std::enable_if_t<std::negation_v<std::is_array<_Ty>>, int> = 0>
-constexpr static Ref<_Ty> CreateRef(_Args&&... args) noexcept
-{
-    return Ref<_Ty>(new _Ty(std::forward<_Args>(args)...));
-}
-
-template<typename _WantedType, typename _RefType>
-constexpr static _WantedType* GetRefBaseTypePtr(const Ref<_RefType>& ref) noexcept
-{
-    return static_cast<_WantedType*>(ref.Raw());
-}
+#ifdef _INTRICATE_POSIX
+inline constexpr size_t _RefChainMaxIovecs = 1024;    // UIO_MAXIOV on Linux, IOV_MAX on macOS
+#endif
 
-template<typename _Ty>
-class WeakRef : public _RefBase<_Ty>
+// Sequence of RefBuffers read as one run of bytes, for building and taking apart messages without copying their fragments.
+// Appending, prepending and splitting only move buffers and slice the one at a boundary. The fragments can be written and read
+// with a single writev()/readv(), Coalesce() copies them into one buffer when contiguous bytes are needed.
+// The fragments are kept in a deque so that prepending is as cheap as appending.
+class RefChain
 {
 public:
-    constexpr WeakRef(const Ref<_Ty>& ref) noexcept { this->_WeaklyConstructFrom(ref); }
-
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr WeakRef(const Ref<_Ty2>& ref) noexcept { this->_WeaklyConstructFrom(ref); }
-
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr WeakRef(const WeakRef<_Ty2>& other) noexcept { this->_WeaklyConstructFrom(other); }
+    RefChain() noexcept = default;
 
-    constexpr WeakRef(const WeakRef<_Ty>& other) noexcept { this->_WeaklyConstructFrom(other); }
+    void Append(const RefBuffer& buffer) noexcept
+    {
+        if (!buffer.Empty())
+        {
+            m_Size += buffer.Size();
+            m_Buffers.push_back(buffer);
+        }
+    }
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr WeakRef(WeakRef<_Ty2>&& other) noexcept { this->_MoveConstructFrom(std::move(other)); }
+    void Append(RefBuffer&& buffer) noexcept
+    {
+        if (!buffer.Empty())
+        {
+            m_Size += buffer.Size();
+            m_Buffers.push_back(std::move(buffer));
+        }
+    }
 
-    constexpr WeakRef(WeakRef<_Ty>&& other) noexcept { this->_MoveConstructFrom(std::move(other)); }
+    // Appending a chain to itself does nothing
+    void Append(RefChain&& chain) noexcept
+    {
+        if (&chain == this)
+            return;
 
-    constexpr WeakRef(std::nullptr_t) noexcept : _RefBase<_Ty>(nullptr) { };
-    constexpr WeakRef() noexcept = default;
-    constexpr ~WeakRef() noexcept { this->_DecWeakRef(); }
+        m_Size += std::exchange(chain.m_Size, 0);
+        m_Buffers.insert(m_Buffers.end(), std::make_move_iterator(chain.m_Buffers.begin()), std::make_move_iterator(chain.m_Buffers.end()));
+        chain.m_Buffers.clear();
+    }
 
-    constexpr void Swap(WeakRef<_Ty>& other) noexcept
+    void Prepend(const RefBuffer& buffer) noexcept
     {
-        if (this != &other)
-            this->_Swap(other);
+        if (!buffer.Empty())
+        {
+            m_Size += buffer.Size();
+            m_Buffers.push_front(buffer);
+        }
     }
 
-    constexpr void Reset() noexcept
+    void Prepend(RefBuffer&& buffer) noexcept
     {
-        WeakRef<_Ty>(nullptr).Swap(*this);
+        if (!buffer.Empty())
+        {
+            m_Size += buffer.Size();
+            m_Buffers.push_front(std::move(buffer));
+        }
     }
 
-    uint32_t RefCount() const noexcept
+    // Prepending a chain to itself does nothing
+    void Prepend(RefChain&& chain) noexcept
     {
-        return this->_RefCount();
+        if (&chain == this)
+            return;
+
+        m_Size += std::exchange(chain.m_Size, 0);
+        m_Buffers.insert(m_Buffers.begin(), std::make_move_iterator(chain.m_Buffers.begin()), std::make_move_iterator(chain.m_Buffers.end()));
+        chain.m_Buffers.clear();
     }
 
-    bool Unique() const noexcept
+    // Removes the first count bytes and returns them as a chain of their own
+    RefChain Split(size_t count) noexcept
     {
-        return RefCount() == 1;
+        RefChain res;
+        count = std::min(count, m_Size);
+        m_Size -= count;
+
+        for (; !m_Buffers.empty() && (m_Buffers.front().Size() <= count); m_Buffers.pop_front())
+        {
+            count -= m_Buffers.front().Size();
+            res.Append(std::move(m_Buffers.front()));
+        }
+
+        if (count)
+        {
+            res.Append(m_Buffers.front().Slice(0, count));
+            m_Buffers.front().TrimStart(count);
+        }
+
+        return res;
     }
 
-    bool Expired() const noexcept
+    // Drops the first count bytes
+    void TrimStart(size_t count) noexcept
     {
-        return RefCount() == 0;
+        count = std::min(count, m_Size);
+        m_Size -= count;
+
+        for (; !m_Buffers.empty() && (m_Buffers.front().Size() <= count); m_Buffers.pop_front())
+            count -= m_Buffers.front().Size();
+
+        if (count)
+            m_Buffers.front().TrimStart(count);
     }
 
-    constexpr _Ty* Raw() const noexcept
+    // Copies the fragments into a single buffer, which replaces them, unless there is only one already.
+    // An empty chain is left without fragments and returns an empty buffer.
+    const RefBuffer& Coalesce() noexcept
     {
-        return this->_Raw();
+        static const RefBuffer s_Empty;
+        if (m_Buffers.empty())
+            return s_Empty;
+
+        if (m_Buffers.size() > 1)
+        {
+            RefBuffer res = RefBuffer::Create(m_Size);
+            for (const RefBuffer& buffer : m_Buffers)
+                res.Append(buffer.Span());
+
+            m_Buffers.clear();
+            m_Buffers.push_back(std::move(res));
+        }
+
+        return m_Buffers.front();
     }
 
-    constexpr bool Valid() const noexcept
+#ifdef _INTRICATE_POSIX
+    // Describes up to maxCount of the fragments from the front of the chain, returns how many bytes they hold
+    size_t GetIovecs(std::vector<iovec>& out, size_t maxCount = _RefChainMaxIovecs) const noexcept
     {
-        return Raw() != nullptr;
+        out.clear();
+        size_t bytes = 0;
+
+        for (size_t i = 0; i < std::min(m_Buffers.size(), maxCount); ++i)
+        {
+            // writev() does not write to the fragments even though iovec is not const
+            out.push_back({ const_cast<std::byte*>(m_Buffers[i].Data()), m_Buffers[i].Size() });
+            bytes += m_Buffers[i].Size();
+        }
+
+        return bytes;
     }
 
-    Ref<_Ty> Lock() const noexcept
+    // Writes the whole chain with writev(), dropping the bytes written. Returns how many bytes were written, which is less than
+    // Size() if the file would block or stops accepting bytes, or -1 if nothing could be written because of an error.
+    ssize_t WriteTo(int file) noexcept
     {
-        if (Expired())
-            return nullptr;
+        std::vector<iovec> iovecs;
+        ssize_t written = 0;
 
-        Ref<_Ty> res;
-        res._ConstructFromWeak(*this);
+        while (!Empty())
+        {
+            GetIovecs(iovecs);
+            const ssize_t res = ::writev(file, iovecs.data(), static_cast<int>(iovecs.size()));
+            if (res < 0)
+            {
+                if (errno == EINTR)
+                    continue;
 
-        return res;
-    }
+                return written ? written : -1;
+            }
 
-    constexpr explicit operator bool() const noexcept { return Valid(); }
-    constexpr operator WeakRef<const _Ty>() const noexcept { return WeakRef<const _Ty>{ this->m_Ptr, this->m_RefCount, this->m_WeakRefCount }; }
+            // Nothing was written, trying again would spin
+            if (res == 0)
+                break;
 
-    WeakRef<_Ty>& operator=(const WeakRef<_Ty>& other) noexcept
-    {
-        WeakRef<_Ty>(other).Swap(*this);
-        return *this;
+            TrimStart(static_cast<size_t>(res));
+            written += res;
+        }
+
+        return written;
     }
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr WeakRef<_Ty>& operator=(const WeakRef<_Ty2>& other) noexcept
+    // Reads up to maxBytes with a single readv() into new buffers of bufferSize bytes and appends what was read.
+    // Returns how many bytes were read, 0 at the end of the file, or -1 on error.
+    ssize_t ReadFrom(int file, size_t maxBytes, size_t bufferSize = 16 * 1024) noexcept
     {
-        WeakRef<_Ty>(other).Swap(*this);
-        return *this;
+        std::vector<RefBuffer> buffers;
+        std::vector<iovec> iovecs;
+
+        for (size_t remaining = maxBytes; remaining && (iovecs.size() < _RefChainMaxIovecs); )
+        {
+            const size_t size = std::min(std::max<size_t>(bufferSize, 1), remaining);
+            buffers.push_back(RefBuffer::Create(size));
+            iovecs.push_back({ buffers.back().WritableTail(), size });
+            remaining -= size;
+        }
+
+        ssize_t res;
+        do
+        {
+            res = ::readv(file, iovecs.data(), static_cast<int>(iovecs.size()));
+        } while ((res < 0) && (errno == EINTR));
+
+        for (size_t i = 0, left = (res > 0) ? static_cast<size_t>(res) : 0; left; ++i)
+        {
+            buffers[i].Commit(left);
+            left -= buffers[i].Size();
+            Append(std::move(buffers[i]));
+        }
+
+        return res;
     }
+#endif
 
-    WeakRef<_Ty>& operator=(WeakRef<_Ty>&& other) noexcept
+    void Clear() noexcept
     {
-        WeakRef<_Ty>(std::move(other)).Swap(*this);
-        return *this;
+        m_Buffers.clear();
+        m_Size = 0;
     }
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr WeakRef<_Ty>& operator=(WeakRef<_Ty2>&& other) noexcept
+    size_t Size() const noexcept
     {
-        WeakRef<_Ty>(std::move(other)).Swap(*this);
-        return *this;
+        return m_Size;
     }
 
-    WeakRef<_Ty>& operator=(const Ref<_Ty>& ref) noexcept
+    bool Empty() const noexcept
     {
-        WeakRef<_Ty>(ref).Swap(*this);
-        return *this;
+        return m_Size == 0;
     }
 
-    template<typename _Ty2, std::enable_if_t<std::is_base_of_v<_Ty, _Ty2>, int> = 0>
-    constexpr WeakRef<_Ty>& operator=(const Ref<_Ty2>& ref) noexcept
+    size_t BufferCount() const noexcept
     {
-        WeakRef<_Ty>(ref).Swap(*this);
-        return *this;
+        return m_Buffers.size();
     }
 
-    constexpr WeakRef<_Ty>& operator=(std::nullptr_t) noexcept
+    const RefBuffer& operator[](size_t idx) const noexcept
     {
-        WeakRef<_Ty>(nullptr).Swap(*this);
-        return *this;
+        return m_Buffers[idx];
     }
 
+    std::deque<RefBuffer>::const_iterator begin() const noexcept { return m_Buffers.begin(); }
+    std::deque<RefBuffer>::const_iterator end() const noexcept { return m_Buffers.end(); }
+
 private:
-    template<typename _Ty2>
-    friend class WeakRef;
+    std::deque<RefBuffer> m_Buffers;
+    size_t m_Size = 0;
 };
 
 template<typename _Ty>
@@ -1005,4 +5896,10 @@ namespace std
     {
         size_t operator()(const _INTRICATE WeakRef<_Ty>& ptr) const noexcept { return hash<_Ty*>{}(ptr.Raw()); }
     };
+
+    template<typename _Ty>
+    struct hash<_INTRICATE Handle<_Ty>>
+    {
+        size_t operator()(const _INTRICATE Handle<_Ty>& handle) const noexcept { return hash<uint64_t>{}((static_cast<uint64_t>(handle.Generation()) << 32) | handle.Index()); }
+    };
 }
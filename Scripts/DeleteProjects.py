@@ -31,13 +31,33 @@ def DeleteTests():
     DeleteFile("Tests/Test-ScopeMemoryLeak/Test-ScopeMemoryLeak.vcxproj.filters")
     DeleteFile("Tests/Test-ScopeMemoryLeak/Test-ScopeMemoryLeak.vcxproj.user")
 
+    DeleteFile("Tests/Test-SharedRefMultiProcess/Test-SharedRefMultiProcess.vcxproj")
+    DeleteFile("Tests/Test-SharedRefMultiProcess/Test-SharedRefMultiProcess.vcxproj.filters")
+    DeleteFile("Tests/Test-SharedRefMultiProcess/Test-SharedRefMultiProcess.vcxproj.user")
+
     DeleteFile("Tests/Test-WeakRefMemoryLeak/Test-WeakRefMemoryLeak.vcxproj")
     DeleteFile("Tests/Test-WeakRefMemoryLeak/Test-WeakRefMemoryLeak.vcxproj.filters")
     DeleteFile("Tests/Test-WeakRefMemoryLeak/Test-WeakRefMemoryLeak.vcxproj.user")
 
+def DeleteBenchmarks():
+    DeleteFile("Benchmarks/Benchmarks.sln")
+
+    DeleteFile("Benchmarks/Bench-BulkRefCount/Bench-BulkRefCount.vcxproj")
+    DeleteFile("Benchmarks/Bench-BulkRefCount/Bench-BulkRefCount.vcxproj.filters")
+    DeleteFile("Benchmarks/Bench-BulkRefCount/Bench-BulkRefCount.vcxproj.user")
+
+    DeleteFile("Benchmarks/Bench-MappedFile/Bench-MappedFile.vcxproj")
+    DeleteFile("Benchmarks/Bench-MappedFile/Bench-MappedFile.vcxproj.filters")
+    DeleteFile("Benchmarks/Bench-MappedFile/Bench-MappedFile.vcxproj.user")
+
+    DeleteFile("Benchmarks/Bench-RefHashSet/Bench-RefHashSet.vcxproj")
+    DeleteFile("Benchmarks/Bench-RefHashSet/Bench-RefHashSet.vcxproj.filters")
+    DeleteFile("Benchmarks/Bench-RefHashSet/Bench-RefHashSet.vcxproj.user")
+
 def Delete():
     DeleteExamples()
     DeleteTests()
+    DeleteBenchmarks()
 
 if __name__ == "__main__":
     os.chdir("../")
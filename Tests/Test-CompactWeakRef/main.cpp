@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cstdlib>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+// Counts the live allocations, so the tests can tell when a reference is stored out of line
+static size_t s_Allocations = 0;
+
+static void* Allocate(size_t size, size_t alignment) noexcept
+{
+    ++s_Allocations;
+    size = (size + alignment - 1) & ~(alignment - 1);
+    return std::aligned_alloc(alignment, size ? size : alignment);
+}
+
+static void Free(void* ptr) noexcept
+{
+    if (ptr)
+    {
+        --s_Allocations;
+        std::free(ptr);
+    }
+}
+
+void* operator new(size_t size)
+{
+    if (void* ptr = Allocate(size, alignof(std::max_align_t)))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* ptr = Allocate(size, std::max(static_cast<size_t>(alignment), alignof(std::max_align_t))))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Allocate(size, alignof(std::max_align_t)); }
+void operator delete(void* ptr) noexcept { Free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { Free(ptr); }
+
+struct Header
+{
+    uint64_t Id = 1;
+};
+
+struct Base
+{
+    virtual ~Base() noexcept = default;
+
+    uint64_t Value = 2;
+};
+
+// Base sits at a small non-zero offset, Tail more than 32 KiB past the start of the object
+struct Record : Header, Base
+{
+    uint8_t Payload[40 * 1024] = { };
+    uint64_t Tail = 3;
+};
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static bool RunTest()
+{
+    static_assert(sizeof(CompactWeakRef<Base>) == sizeof(void*));
+
+    bool passed = true;
+    const size_t baseline = s_Allocations;
+
+    {
+        Ref<Record> record = CreateRef<Record>();
+        Ref<Base> base = record;
+        Ref<uint64_t> near(record, &record->Id);
+        Ref<uint64_t> far(record, &record->Tail);
+
+        const size_t before = s_Allocations;
+        CompactWeakRef<Base> compactBase = base;
+        CompactWeakRef<uint64_t> compactNear = near;
+        passed &= Check((s_Allocations == before) && (compactBase.Lock() == base) && (compactNear.Lock() == near), "Small offsets are packed inline");
+
+        CompactWeakRef<uint64_t> compactFar = far;
+        passed &= Check((s_Allocations == before + 1) && (compactFar.Lock() == far) && (*compactFar.Lock() == 3), "Alias beyond 32 KiB spills out of line");
+
+        CompactWeakRef<uint64_t> copy = compactFar;
+        CompactWeakRef<uint64_t> moved = std::move(compactFar);
+        passed &= Check((s_Allocations == before + 2) && !compactFar && (copy.Lock() == far) && (moved.Lock() == far), "Copies own their record, moves take it over");
+
+        // Reassigning to an inline reference frees the record
+        copy = near;
+        passed &= Check((s_Allocations == before + 1) && (copy.RefCount() == 4) && (copy.Lock() == near), "Assigning a packable reference frees the record");
+
+        record.Reset();
+        base.Reset();
+        near.Reset();
+        far.Reset();
+
+        const bool expired = compactBase.Expired() && moved.Expired() && copy.Expired() && (moved.RefCount() == 0);
+        passed &= Check(expired && !compactBase.Lock() && !compactNear.Lock() && !moved.Lock() && !copy.Lock(), "Lock() after expiry returns nullptr");
+        passed &= Check(compactBase && moved, "Expired references stay valid until reset");
+    }
+
+    passed &= Check(s_Allocations == baseline, "Control blocks and records freed with the last reference");
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-CompactWeakRef\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include <iostream>
+#include <cstdlib>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+// Counts the live allocations, so the tests can tell when the batch allocations are freed
+static size_t s_Allocations = 0;
+
+static void* Allocate(size_t size, size_t alignment) noexcept
+{
+    ++s_Allocations;
+    size = (size + alignment - 1) & ~(alignment - 1);
+    return std::aligned_alloc(alignment, size ? size : alignment);
+}
+
+static void Free(void* ptr) noexcept
+{
+    if (ptr)
+    {
+        --s_Allocations;
+        std::free(ptr);
+    }
+}
+
+void* operator new(size_t size)
+{
+    if (void* ptr = Allocate(size, alignof(std::max_align_t)))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* ptr = Allocate(size, std::max(static_cast<size_t>(alignment), alignof(std::max_align_t))))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Allocate(size, alignof(std::max_align_t)); }
+void operator delete(void* ptr) noexcept { Free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { Free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { Free(ptr); }
+
+static size_t s_Destroyed = 0;
+
+struct BatchObject
+{
+    BatchObject(int first, int second) noexcept : Value(first + second) { };
+    ~BatchObject() noexcept { ++s_Destroyed; }
+
+    int Value;
+};
+
+struct SplitObject
+{
+    ~SplitObject() noexcept { ++s_Destroyed; }
+
+    uint64_t Value = 0;
+};
+
+template<> struct Intricate::SplitRefPayload<SplitObject> : std::true_type { };
+
+static constexpr size_t BATCH_SIZE = 100;
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+// Each object is destroyed with its last Ref, while the shared allocation is freed with the last Ref of the batch
+static bool RunBatchFree()
+{
+    s_Destroyed = 0;
+    const size_t allocations = s_Allocations;
+
+    std::vector<Ref<BatchObject>> refs = CreateRefs<BatchObject>(BATCH_SIZE, 20, 22);
+
+    bool constructed = (refs.size() == BATCH_SIZE);
+    for (const Ref<BatchObject>& ref : refs)
+        constructed &= ref && (ref->Value == 42) && ref.Unique();
+
+    // The vector and the batch
+    const bool single = (s_Allocations == allocations + 2);
+    const bool contiguous = (refs[1].Raw() == refs[0].Raw() + 1);
+
+    Ref<BatchObject> last = refs.back();
+    for (Ref<BatchObject>& ref : refs)
+        ref.Reset();
+
+    const bool alive = (s_Destroyed == BATCH_SIZE - 1) && (last->Value == 42) && (s_Allocations == allocations + 2);
+
+    last.Reset();
+    const bool freed = (s_Destroyed == BATCH_SIZE) && (s_Allocations == allocations + 1);
+
+    bool passed = Check(constructed && single && contiguous, "Batch objects share one allocation");
+    passed &= Check(alive && freed, "Last Ref frees the batch");
+    return passed;
+}
+
+// A WeakRef keeps an unsplit batch allocated after every object is destroyed
+static bool RunWeakRefKeepsBatch()
+{
+    s_Destroyed = 0;
+    const size_t allocations = s_Allocations;
+
+    WeakRef<BatchObject> weak;
+    {
+        std::vector<Ref<BatchObject>> refs = CreateRefs<BatchObject>(BATCH_SIZE, 1, 2);
+        weak = refs[BATCH_SIZE / 2];
+    }
+
+    const bool kept = weak.Expired() && (s_Destroyed == BATCH_SIZE) && (s_Allocations == allocations + 1);
+
+    weak.Reset();
+    return Check(kept && (s_Allocations == allocations), "WeakRef keeps the batch until released");
+}
+
+// A split payload is freed with its last object even though a WeakRef still pins the control blocks
+static bool RunSplitPayload()
+{
+    s_Destroyed = 0;
+    const size_t allocations = s_Allocations;
+
+    WeakRef<SplitObject> weak;
+    {
+        std::vector<Ref<SplitObject>> refs = CreateRefs<SplitObject>(BATCH_SIZE);
+        weak = refs.front();
+
+        // The vector, the control blocks and the payload
+        if (s_Allocations != allocations + 3)
+            return Check(false, "Split payload is a second allocation");
+    }
+
+    const bool payloadFreed = weak.Expired() && (s_Destroyed == BATCH_SIZE) && (s_Allocations == allocations + 1);
+
+    weak.Reset();
+    return Check(payloadFreed && (s_Allocations == allocations), "Split payload is freed with its last object");
+}
+
+// Batch objects were not allocated with new, so Release() refuses them and keeps the reference
+static bool RunReleaseRefused()
+{
+    s_Destroyed = 0;
+    const size_t allocations = s_Allocations;
+
+    {
+        std::vector<Ref<BatchObject>> refs = CreateRefs<BatchObject>(2, 0, 7);
+        Ref<BatchObject> copy = refs[0];
+
+        BatchObject* released = refs[0].Release();
+        if ((released != nullptr) || !refs[0] || (refs[0].RefCount() != 2) || (s_Destroyed != 0))
+            return Check(false, "Release() refuses batch objects");
+    }
+
+    return Check((s_Destroyed == 2) && (s_Allocations == allocations), "Release() refuses batch objects");
+}
+
+static bool RunTest()
+{
+    bool passed = RunBatchFree();
+    passed &= RunWeakRefKeepsBatch();
+    passed &= RunSplitPayload();
+    passed &= RunReleaseRefused();
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-CreateRefs\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static constexpr size_t THREAD_COUNT = 8;
+static constexpr size_t OBJECTS_PER_THREAD = 10'000;
+static constexpr size_t OBJECT_COUNT = THREAD_COUNT * OBJECTS_PER_THREAD;
+
+static std::atomic_uint32_t s_Destroyed[OBJECT_COUNT];
+static std::atomic_size_t s_DestroyedTotal = 0;
+static std::atomic<std::thread::id> s_DrainThread;
+static std::atomic_bool s_WrongThread = false;
+
+struct DeferredObject
+{
+    explicit DeferredObject(size_t idx) noexcept : Index(idx) { };
+
+    ~DeferredObject() noexcept
+    {
+        s_Destroyed[Index].fetch_add(1, std::memory_order_relaxed);
+        s_DestroyedTotal.fetch_add(1, std::memory_order_relaxed);
+
+        if (std::this_thread::get_id() != s_DrainThread.load(std::memory_order_relaxed))
+            s_WrongThread.store(true, std::memory_order_relaxed);
+    }
+
+    size_t Index;
+};
+
+template<> struct Intricate::DeferRefDestruction<DeferredObject> : std::true_type { };
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static void Reset() noexcept
+{
+    for (std::atomic_uint32_t& destroyed : s_Destroyed)
+        destroyed.store(0, std::memory_order_relaxed);
+
+    s_DestroyedTotal = 0;
+    s_WrongThread = false;
+}
+
+static bool AllDestroyedOnce() noexcept
+{
+    for (const std::atomic_uint32_t& destroyed : s_Destroyed)
+    {
+        if (destroyed.load(std::memory_order_relaxed) != 1)
+            return false;
+    }
+
+    return true;
+}
+
+// Every thread creates its share of the objects and releases the only Ref to each of them
+static void ReleaseFromThreads()
+{
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREAD_COUNT; ++t)
+    {
+        threads.emplace_back([t]
+        {
+            for (size_t i = 0; i < OBJECTS_PER_THREAD; ++i)
+            {
+                Ref<DeferredObject> ref = CreateRef<DeferredObject>((t * OBJECTS_PER_THREAD) + i);
+                ref.Reset();
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+// Nothing is destroyed by the releasing threads, and a single drain on another thread destroys everything once
+static bool RunReleaseThenDrain()
+{
+    Reset();
+    ReleaseFromThreads();
+
+    bool passed = Check((s_DestroyedTotal == 0) && (GetDeferredDestructionStats().QueueDepth == OBJECT_COUNT), "Releases only enqueue");
+
+    std::thread drainer([]
+    {
+        s_DrainThread = std::this_thread::get_id();
+        (void)DrainDeferred();
+    });
+    drainer.join();
+
+    passed &= Check(AllDestroyedOnce() && !s_WrongThread && (GetDeferredDestructionStats().QueueDepth == 0), "Drain destroys every object once");
+    return passed;
+}
+
+// A thread drains with a small budget while the others are still releasing
+static bool RunConcurrentDrain()
+{
+    Reset();
+
+    std::atomic_bool releasing = true;
+    std::thread drainer([&releasing]
+    {
+        s_DrainThread = std::this_thread::get_id();
+        while (releasing.load(std::memory_order_acquire) || (s_DestroyedTotal.load(std::memory_order_relaxed) < OBJECT_COUNT))
+            (void)DrainDeferred(64);
+    });
+
+    ReleaseFromThreads();
+    releasing.store(false, std::memory_order_release);
+    drainer.join();
+
+    return Check(AllDestroyedOnce() && !s_WrongThread, "Concurrent drain destroys every object once");
+}
+
+// Objects are destroyed in the order they were released, even across drains that run out of budget
+static bool RunDrainOrder()
+{
+    Reset();
+    s_DrainThread = std::this_thread::get_id();
+
+    static constexpr size_t ORDER_COUNT = 100;
+    for (size_t i = 0; i < ORDER_COUNT; ++i)
+        (void)CreateRef<DeferredObject>(i);
+
+    bool ordered = true;
+    for (size_t i = 0; i < ORDER_COUNT; ++i)
+        ordered &= (DrainDeferred(1) == 1) && (s_Destroyed[i] == 1) && ((i + 1 == ORDER_COUNT) || (s_Destroyed[i + 1] == 0));
+
+    return Check(ordered && (DrainDeferred() == 0), "Objects are destroyed in release order");
+}
+
+// The reclaimer's thread drains the queue without being asked
+static bool RunReclaimer()
+{
+    Reset();
+
+    {
+        DeferredReclaimer reclaimer(std::chrono::milliseconds(1));
+
+        (void)CreateRef<DeferredObject>(0);
+        reclaimer.Wake();
+
+        for (int i = 0; (i < 5000) && (s_DestroyedTotal == 0); ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return Check((s_Destroyed[0] == 1) && (s_DestroyedTotal == 1), "DeferredReclaimer drains the queue");
+}
+
+static bool RunTest()
+{
+    bool passed = RunReleaseThenDrain();
+    passed &= RunConcurrentDrain();
+    passed &= RunDrainOrder();
+    passed &= RunReclaimer();
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-DeferredDestruction\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
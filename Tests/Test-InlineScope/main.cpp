@@ -0,0 +1,133 @@
+#include <iostream>
+#include <string>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static int64_t s_Live = 0;
+static size_t s_Destroyed = 0;
+
+// No virtual destructor, InlineScope destroys the object as its own type
+struct Strategy
+{
+    uint64_t Kind = 0;
+};
+
+struct NamedStrategy : Strategy
+{
+    explicit NamedStrategy(const std::string& name) noexcept : Name(name) { Kind = 1; ++s_Live; }
+    NamedStrategy(NamedStrategy&& other) noexcept : Strategy(other), Name(std::move(other.Name)) { ++s_Live; }
+    ~NamedStrategy() noexcept { --s_Live; ++s_Destroyed; }
+
+    std::string Name;
+};
+
+struct LargeStrategy : Strategy
+{
+    LargeStrategy() noexcept { Kind = 2; ++s_Live; }
+    ~LargeStrategy() noexcept { --s_Live; ++s_Destroyed; }
+
+    uint8_t Table[256] = { };
+};
+
+// Fits in size but may throw when moved, so it goes to the heap
+struct ThrowingMoveStrategy : Strategy
+{
+    ThrowingMoveStrategy() noexcept { Kind = 3; ++s_Live; }
+    ThrowingMoveStrategy(ThrowingMoveStrategy&&) { Kind = 3; ++s_Live; }
+    ~ThrowingMoveStrategy() noexcept { --s_Live; ++s_Destroyed; }
+};
+
+using StrategyScope = InlineScope<Strategy>;
+
+static const std::string s_Name = "a name long enough to live on the heap rather than in the string";
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static bool NameIs(const StrategyScope& scope, const std::string& name) noexcept
+{
+    return scope && (scope->Kind == 1) && (static_cast<NamedStrategy*>(scope.Raw())->Name == name);
+}
+
+static bool RunInline()
+{
+    s_Destroyed = 0;
+    bool passed = true;
+
+    {
+        StrategyScope scope = CreateInlineScope<Strategy, NamedStrategy>(s_Name);
+        passed &= Check(scope.IsInline() && NameIs(scope, s_Name) && (s_Live == 1), "Small object is constructed inline");
+
+        const Strategy* before = scope.Raw();
+        StrategyScope moved = std::move(scope);
+        passed &= Check(!scope && !scope.IsInline() && moved.IsInline() && (moved.Raw() != before), "Move relocates into the destination");
+        passed &= Check(NameIs(moved, s_Name) && (s_Live == 1) && (s_Destroyed == 1), "Relocation destroys the moved-from object");
+
+        StrategyScope assigned;
+        assigned = std::move(moved);
+        passed &= Check(!moved && NameIs(assigned, s_Name) && (s_Live == 1), "Move assignment relocates");
+
+        // The new object is built from the current one before it is destroyed
+        NamedStrategy& replaced = assigned.Emplace<NamedStrategy>(static_cast<NamedStrategy*>(assigned.Raw())->Name + "!");
+        passed &= Check((&replaced == assigned.Raw()) && NameIs(assigned, s_Name + "!") && (s_Live == 1), "Emplace replaces the object");
+
+        assigned.Reset();
+        passed &= Check(!assigned && (s_Live == 0), "Reset destroys the derived object");
+
+        assigned.Emplace<NamedStrategy>(s_Name);
+    }
+
+    passed &= Check(s_Live == 0, "Destructor destroys the derived object");
+    return passed;
+}
+
+static bool RunHeap()
+{
+    bool passed = true;
+
+    {
+        StrategyScope large = CreateInlineScope<Strategy, LargeStrategy>();
+        StrategyScope throwing = CreateInlineScope<Strategy, ThrowingMoveStrategy>();
+        passed &= Check(!large.IsInline() && !throwing.IsInline() && (large->Kind == 2) && (throwing->Kind == 3) && (s_Live == 2), "Large and throwing-move objects fall back to the heap");
+
+        const Strategy* before = large.Raw();
+        StrategyScope moved = std::move(large);
+        passed &= Check(!large && (moved.Raw() == before) && (s_Live == 2), "Heap object moves by pointer");
+
+        StrategyScope named = CreateInlineScope<Strategy, NamedStrategy>(s_Name);
+        named.Swap(moved);
+        passed &= Check((named.Raw() == before) && !named.IsInline() && moved.IsInline() && NameIs(moved, s_Name) && (s_Live == 3), "Swap of an inline and a heap object");
+
+        named = nullptr;
+        passed &= Check(!named && (s_Live == 2), "Assigning nullptr destroys a heap object");
+    }
+
+    passed &= Check(s_Live == 0, "Every object destroyed");
+    return passed;
+}
+
+static bool RunTest()
+{
+    static_assert(StrategyScope::FitsInline<NamedStrategy>);
+    static_assert(!StrategyScope::FitsInline<LargeStrategy> && !StrategyScope::FitsInline<ThrowingMoveStrategy>);
+
+    bool passed = RunInline();
+    passed &= RunHeap();
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-InlineScope\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static int64_t s_Live = 0;
+
+struct Listener
+{
+    explicit Listener(uint64_t id) noexcept : Id(id) { ++s_Live; }
+    ~Listener() noexcept { --s_Live; }
+
+    uint64_t Id;
+};
+
+static constexpr size_t LISTENER_COUNT = 100;
+static constexpr size_t EXPIRED_INDEX = 37;
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static std::vector<Ref<Listener>> CreateListeners(size_t count)
+{
+    std::vector<Ref<Listener>> listeners;
+    for (size_t i = 0; i < count; ++i)
+        listeners.push_back(CreateRef<Listener>(i));
+
+    return listeners;
+}
+
+// The live entries skip over the expired one, in order
+static bool MatchesAllBut(const std::vector<Ref<Listener>>& refs, size_t skipped) noexcept
+{
+    bool matches = (refs.size() == LISTENER_COUNT - 1);
+    for (size_t i = 0; matches && (i < refs.size()); ++i)
+        matches &= (refs[i]->Id == ((i < skipped) ? i : (i + 1)));
+
+    return matches;
+}
+
+// A single expired entry is dropped without affecting any of the others
+static bool RunOneExpired()
+{
+    bool passed = true;
+    std::vector<Ref<Listener>> owners = CreateListeners(LISTENER_COUNT);
+    std::vector<WeakRef<Listener>> weakRefs(owners.begin(), owners.end());
+
+    owners[EXPIRED_INDEX] = nullptr;
+
+    std::vector<Ref<Listener>> locked = { owners[0] };
+    const size_t live = LockAll(std::span<WeakRef<Listener>>(weakRefs), locked);
+
+    bool compacted = (live == LISTENER_COUNT - 1) && (weakRefs.size() == LISTENER_COUNT) && weakRefs.back().Expired() && !weakRefs.back().Raw();
+    for (size_t i = 0; i < live; ++i)
+        compacted &= (weakRefs[i].Raw() == locked[i + 1].Raw());
+
+    locked.erase(locked.begin());
+    passed &= Check(MatchesAllBut(locked, EXPIRED_INDEX) && (owners[0].RefCount() == 2), "Span overload locks every live entry and appends after existing ones");
+    passed &= Check(compacted, "Span overload moves the live entries to the front");
+
+    std::vector<Ref<Listener>> relocked;
+    weakRefs.push_back(WeakRef<Listener>());
+    LockAll(weakRefs, relocked);
+    passed &= Check(MatchesAllBut(relocked, EXPIRED_INDEX) && (weakRefs.size() == LISTENER_COUNT - 1), "Vector overload erases expired and empty entries");
+
+    return passed;
+}
+
+static bool RunAllExpired()
+{
+    std::vector<Ref<Listener>> owners = CreateListeners(8);
+    std::vector<WeakRef<Listener>> weakRefs(owners.begin(), owners.end());
+    owners.clear();
+
+    std::vector<Ref<Listener>> locked;
+    LockAll(weakRefs, locked);
+    return Check(locked.empty() && weakRefs.empty() && (s_Live == 0), "Every entry expired");
+}
+
+// Entries expiring while they are being locked are either locked with their object alive or dropped
+static bool RunConcurrentExpiry()
+{
+    std::vector<Ref<Listener>> owners = CreateListeners(LISTENER_COUNT * 100);
+    std::vector<WeakRef<Listener>> weakRefs(owners.begin(), owners.end());
+    std::atomic<bool> start = false;
+
+    std::thread releaser([&]()
+    {
+        while (!start.load(std::memory_order_acquire)) { }
+
+        for (size_t i = 0; i < owners.size(); i += 2)
+            owners[i] = nullptr;
+    });
+
+    std::vector<Ref<Listener>> locked;
+    start.store(true, std::memory_order_release);
+    LockAll(weakRefs, locked);
+    releaser.join();
+
+    bool valid = (locked.size() == weakRefs.size()) && (locked.size() >= owners.size() / 2);
+    for (size_t i = 0; valid && (i < locked.size()); ++i)
+        valid &= (locked[i].Raw() == weakRefs[i].Raw()) && ((i == 0) || (locked[i]->Id > locked[i - 1]->Id));
+
+    const bool passed = Check(valid, "Concurrent expiry");
+
+    locked.clear();
+    owners.clear();
+    return passed && Check(s_Live == 0, "Every object destroyed");
+}
+
+static bool RunTest()
+{
+    bool passed = RunOneExpired();
+    passed &= RunAllExpired();
+    passed &= RunConcurrentExpiry();
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-LockAll\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
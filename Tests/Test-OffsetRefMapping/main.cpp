@@ -0,0 +1,140 @@
+#include <iostream>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+#ifdef _INTRICATE_POSIX
+struct MappedNode
+{
+    uint64_t Value = 0;
+    OffsetRef<MappedNode> Next;
+};
+
+struct MappedRoot
+{
+    uint64_t Count = 0;
+    OffsetRef<MappedNode> Head;
+    OffsetScope<MappedNode> Tail;
+};
+
+static constexpr const char* FILE_PATH = "Test-OffsetRefMapping.bin";
+static constexpr size_t FILE_SIZE = 64 * 1024;
+static constexpr uint64_t NODE_COUNT = 100;
+
+// Builds a list of the values 0 to NODE_COUNT - 1 through a writable shared mapping of the file
+static bool BuildFile(int fd) noexcept
+{
+    void* mapping = mmap(nullptr, FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    std::span<std::byte> region(static_cast<std::byte*>(mapping), FILE_SIZE);
+    OffsetArena arena(region, true);
+
+    MappedRoot* root = arena.Create<MappedRoot>();
+    for (uint64_t i = NODE_COUNT; i-- > 0;)
+    {
+        OffsetRef<MappedNode> node = arena.CreateRef<MappedNode>();
+        node->Value = i;
+        node->Next = root->Head;
+        root->Head = std::move(node);
+        ++root->Count;
+    }
+
+    root->Tail = arena.CreateScope<MappedNode>();
+    root->Tail->Value = NODE_COUNT;
+
+    const bool built = (root == OffsetArena::At<MappedRoot>(region)) && root->Head && root->Head.Immortal();
+    return (munmap(mapping, FILE_SIZE) == 0) && built;
+}
+
+// Maps the file read-only while the old address range is still taken, so the graph is walked at a different address.
+// Any write to a count would fault on the read-only pages.
+static bool WalkFile(int fd) noexcept
+{
+    void* blocker = mmap(nullptr, FILE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    void* mapping = mmap(nullptr, FILE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    if ((blocker == MAP_FAILED) || (mapping == MAP_FAILED))
+        return false;
+
+    const MappedRoot* root = OffsetArena::At<MappedRoot>(std::span<std::byte>(static_cast<std::byte*>(mapping), FILE_SIZE));
+
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    for (OffsetRef<MappedNode> node = root->Head; node; node = node->Next)
+    {
+        ++count;
+        sum += node->Value;
+    }
+
+    std::cout << "Walked nodes: " << count << ", sum: " << sum << '\n';
+    const bool passed = (count == root->Count) && (count == NODE_COUNT) && (sum == (NODE_COUNT * (NODE_COUNT - 1) / 2)) && (root->Tail->Value == NODE_COUNT);
+
+    (void)munmap(mapping, FILE_SIZE);
+    (void)munmap(blocker, FILE_SIZE);
+    return passed;
+}
+
+static size_t s_Destroyed = 0;
+
+struct CountedNode
+{
+    ~CountedNode() noexcept { ++s_Destroyed; }
+
+    OffsetRef<CountedNode> Next;
+};
+
+// Objects of an arena that is not immortal are counted and destroyed by their final release
+static bool RunCountedArena() noexcept
+{
+    alignas(std::max_align_t) static std::byte storage[4096];
+    OffsetArena arena(storage);
+
+    {
+        OffsetRef<CountedNode> first = arena.CreateRef<CountedNode>();
+        first->Next = arena.CreateRef<CountedNode>();
+
+        OffsetRef<CountedNode> copy = first;
+        if ((first.RefCount() != 2) || (first->Next.RefCount() != 1))
+            return false;
+    }
+
+    std::cout << "Destroyed counted objects: " << s_Destroyed << '\n';
+    return s_Destroyed == 2;
+}
+
+static bool RunTest() noexcept
+{
+    int fd = open(FILE_PATH, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if ((fd < 0) || (ftruncate(fd, FILE_SIZE) != 0))
+    {
+        std::cout << "Failed to create " << FILE_PATH << '\n';
+        return false;
+    }
+
+    bool passed = BuildFile(fd) && WalkFile(fd);
+    std::cout << "Remapped graph: " << (passed ? "OK" : "FAILED") << '\n';
+
+    close(fd);
+    unlink(FILE_PATH);
+
+    passed &= RunCountedArena();
+    return passed;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-OffsetRefMapping\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+#ifdef _INTRICATE_POSIX
+    std::cout << (RunTest() ? "PASSED\n" : "FAILED\n");
+#else
+    std::cout << "Mapping the arena requires POSIX mmap\n";
+#endif
+
+    std::cin.get();
+    return 0;
+}
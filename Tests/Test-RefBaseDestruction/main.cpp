@@ -0,0 +1,102 @@
+#include <iostream>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static size_t s_BaseDestroyed = 0;
+static size_t s_DerivedDestroyed = 0;
+
+// No virtual destructor, deleting a Derived through a Base* would skip ~Derived
+struct Base
+{
+    ~Base() noexcept { ++s_BaseDestroyed; }
+
+    uint64_t Value = 1;
+};
+
+struct Derived : Base
+{
+    ~Derived() noexcept { ++s_DerivedDestroyed; }
+
+    uint64_t Extra = 2;
+};
+
+struct Header
+{
+    uint64_t Id = 3;
+};
+
+// Base sits at a non-zero offset
+struct OffsetDerived : Header, Base
+{
+    ~OffsetDerived() noexcept { ++s_DerivedDestroyed; }
+};
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static bool Destroyed(size_t count) noexcept
+{
+    const bool destroyed = (s_BaseDestroyed == count) && (s_DerivedDestroyed == count);
+    s_BaseDestroyed = 0;
+    s_DerivedDestroyed = 0;
+    return destroyed;
+}
+
+static bool RunTest()
+{
+    bool passed = true;
+
+    {
+        Ref<Base> ref = CreateRef<Derived>();
+    }
+
+    passed &= Check(Destroyed(1), "CreateRef<Derived> through a Ref<Base>");
+
+    {
+        Ref<Base> ref(new Derived());
+        Ref<Base> copy = ref;
+        ref.Reset();
+        passed &= Check(Destroyed(0), "Copy keeps the object alive");
+    }
+
+    passed &= Check(Destroyed(1), "Ref<Base>(new Derived)");
+
+    {
+        Ref<Base> ref(new Derived());
+        ref.Reset(new Derived());
+        passed &= Check(Destroyed(1) && (ref->Value == 1), "Reset(new Derived) destroys the previous object");
+
+        ref.Reset(new OffsetDerived());
+        passed &= Check(Destroyed(1) && (ref->Value == 1), "Reset to a base at a non-zero offset");
+    }
+
+    passed &= Check(Destroyed(1), "Reset(new OffsetDerived)");
+
+    {
+        WeakRef<Base> weak;
+        {
+            Ref<Base> ref(new OffsetDerived());
+            weak = ref;
+        }
+
+        passed &= Check(Destroyed(1) && weak.Expired(), "Last Ref destroys the object while a WeakRef remains");
+    }
+
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-RefBaseDestruction\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <iostream>
+#include <string>
+#include <IntricatePointers/IntricatePointers.hpp>
+#ifdef __linux__
+    #include <sys/syscall.h>
+#endif
+using namespace Intricate;
+
+
+#ifdef __linux__
+// Replaces the libc writev() so that a file which stops accepting bytes can be simulated
+static bool s_WritevAcceptsNothing = false;
+
+extern "C" ssize_t writev(int file, const iovec* iovecs, int count) noexcept
+{
+    if (s_WritevAcceptsNothing)
+        return 0;
+
+    return static_cast<ssize_t>(syscall(SYS_writev, file, iovecs, count));
+}
+#endif
+
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static std::string ChainText(const RefChain& chain)
+{
+    std::string res;
+    for (const RefBuffer& buffer : chain)
+        res += buffer.View();
+
+    return res;
+}
+
+// A slice shares its allocation, so appending to it has to copy instead of writing over the bytes after it
+static bool RunSliceAppend() noexcept
+{
+    RefBuffer buffer = RefBuffer::Copy("hello world", 16);
+    const std::byte* data = buffer.Data();
+
+    RefBuffer slice = buffer.Slice(0, 5);
+    slice.Append(" there");
+
+    bool passed = Check((buffer.View() == "hello world") && (slice.View() == "hello there"), "Slice append leaves the source intact");
+    passed &= Check((slice.Data() != data) && buffer.Unique() && slice.Unique(), "Slice append copies into its own allocation");
+
+    // Once the slice is the only reference, the room after it is written in place
+    slice = buffer.Slice(6);
+    buffer.Reset();
+
+    const std::byte* sliceData = slice.Data();
+    slice.Append("!");
+    passed &= Check((slice.View() == "world!") && (slice.Data() == sliceData), "Unique slice appends in place");
+
+    // A buffer can append its own bytes
+    slice.Append(slice.Span());
+    passed &= Check(slice.View() == "world!world!", "Self append");
+
+    return passed;
+}
+
+static RefChain MakeChain()
+{
+    RefChain chain;
+    chain.Append(RefBuffer::Copy("defg"));
+    chain.Append(RefBuffer::Copy("hij"));
+    chain.Prepend(RefBuffer::Copy("abc"));
+    return chain;
+}
+
+static bool RunChainSplit()
+{
+    bool passed = true;
+
+    {
+        RefChain chain = MakeChain();
+        RefChain front = chain.Split(3);
+        passed &= Check((ChainText(front) == "abc") && (front.BufferCount() == 1) && (ChainText(chain) == "defghij") && (chain.BufferCount() == 2), "Split at a fragment boundary");
+    }
+
+    {
+        RefChain chain = MakeChain();
+        RefChain front = chain.Split(5);
+        passed &= Check((ChainText(front) == "abcde") && (front.Size() == 5) && (ChainText(chain) == "fghij") && (chain.Size() == 5), "Split inside a fragment");
+        passed &= Check((front[1].Data() + 2) == chain[0].Data(), "Split fragment shares its allocation");
+    }
+
+    {
+        RefChain chain = MakeChain();
+        RefChain all = chain.Split(100);
+        passed &= Check((ChainText(all) == "abcdefghij") && chain.Empty() && (chain.BufferCount() == 0), "Split past the end");
+    }
+
+    {
+        RefChain chain = MakeChain();
+        chain.TrimStart(4);
+        passed &= Check((ChainText(chain) == "efghij") && (chain.Size() == 6) && (chain.BufferCount() == 2), "TrimStart inside a fragment");
+    }
+
+    {
+        RefChain chain = MakeChain();
+        chain.Append(std::move(chain));
+        chain.Prepend(std::move(chain));
+        passed &= Check((ChainText(chain) == "abcdefghij") && (chain.Size() == 10), "Appending a chain to itself");
+    }
+
+    return passed;
+}
+
+static bool RunCoalesce()
+{
+    RefChain chain;
+    const RefBuffer& empty = chain.Coalesce();
+    bool passed = Check(empty.Empty() && (chain.BufferCount() == 0) && (chain.begin() == chain.end()), "Coalescing an empty chain adds no fragment");
+
+    chain = MakeChain();
+    const RefBuffer& whole = chain.Coalesce();
+    passed &= Check((whole.View() == "abcdefghij") && (chain.BufferCount() == 1) && (&chain.Coalesce() == &whole), "Coalesce copies the fragments once");
+
+    chain.TrimStart(chain.Size());
+    passed &= Check(chain.Empty() && chain.Coalesce().Empty() && (chain.BufferCount() == 0), "Coalescing a trimmed chain");
+    return passed;
+}
+
+#ifdef _INTRICATE_POSIX
+// Writes a chain into a pipe with writev() and reads it back with readv() into small buffers
+static bool RunPipeRoundTrip()
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return Check(false, "Creating a pipe");
+
+    std::string text;
+    RefChain out;
+    for (int i = 0; i < 64; ++i)
+    {
+        std::string line = "line " + std::to_string(i) + '\n';
+        text += line;
+        out.Append(RefBuffer::Copy(line));
+    }
+
+    const ssize_t written = out.WriteTo(fds[1]);
+    close(fds[1]);
+
+    RefChain in;
+    ssize_t read;
+    while ((read = in.ReadFrom(fds[0], 100, 7)) > 0) { };
+    close(fds[0]);
+
+    bool passed = Check((written == static_cast<ssize_t>(text.size())) && out.Empty(), "WriteTo a pipe");
+    passed &= Check((read == 0) && (in.Size() == text.size()) && (ChainText(in) == text), "ReadFrom a pipe");
+    passed &= Check(in.Coalesce().View() == text, "Coalesce");
+    return passed;
+}
+#endif
+
+#ifdef __linux__
+// A writev() that returns 0 ends the write instead of being retried forever
+static bool RunWriteAcceptsNothing()
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+        return Check(false, "Creating a pipe");
+
+    RefChain chain = MakeChain();
+    s_WritevAcceptsNothing = true;
+    const ssize_t written = chain.WriteTo(fds[1]);
+    s_WritevAcceptsNothing = false;
+
+    bool passed = Check((written == 0) && (ChainText(chain) == "abcdefghij"), "WriteTo stops when nothing is written");
+    passed &= Check((chain.WriteTo(fds[1]) == 10) && chain.Empty(), "WriteTo resumes with the bytes left");
+
+    close(fds[0]);
+    close(fds[1]);
+    return passed;
+}
+#endif
+
+static bool RunTest()
+{
+    bool passed = RunSliceAppend();
+    passed &= RunChainSplit();
+    passed &= RunCoalesce();
+#ifdef _INTRICATE_POSIX
+    passed &= RunPipeRoundTrip();
+#endif
+#ifdef __linux__
+    passed &= RunWriteAcceptsNothing();
+#endif
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-RefBufferChain\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static size_t s_Destroyed = 0;
+
+struct Shape
+{
+    virtual ~Shape() noexcept { ++s_Destroyed; }
+
+    uint64_t Id = 0;
+};
+
+struct Circle : Shape
+{
+    ~Circle() noexcept override { ++s_Destroyed; }
+
+    uint64_t Radius = 5;
+};
+
+struct Square : Shape
+{
+    uint64_t Side = 4;
+};
+
+// No virtual destructor, a Ref<void> must still destroy it as a Plain
+struct Plain
+{
+    ~Plain() noexcept { ++s_Destroyed; }
+};
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static bool RunVoid()
+{
+    s_Destroyed = 0;
+    bool passed = true;
+
+    {
+        Ref<void> erased = CreateRef<Plain>();
+        Ref<void> copy = erased;
+        passed &= Check((erased.RefCount() == 2) && (copy.Raw() == erased.Raw()), "Ref<void> shares the count");
+
+        Ref<Plain> typed = StaticRefCast<Plain>(std::move(erased));
+        passed &= Check(!erased && (typed.RefCount() == 2) && (typed.Raw() == copy.Raw()), "Cast from Ref<void> moves the reference");
+    }
+
+    passed &= Check(s_Destroyed == 1, "Ref<void> destroys as the created type");
+    return passed;
+}
+
+static bool RunRefCasts()
+{
+    s_Destroyed = 0;
+    bool passed = true;
+
+    {
+        Ref<Shape> shape = CreateRef<Circle>();
+
+        Ref<Circle> circle = StaticRefCast<Circle>(shape);
+        passed &= Check((circle.Raw() == shape.Raw()) && (shape.RefCount() == 2) && (circle->Radius == 5), "StaticRefCast copies the reference");
+
+        Ref<Circle> dynamicCircle = DynamicRefCast<Circle>(shape);
+        Ref<Square> square = DynamicRefCast<Square>(shape);
+        passed &= Check(dynamicCircle && !square && (shape.RefCount() == 3), "DynamicRefCast of an lvalue");
+
+        Ref<Shape> moved = shape;
+        Ref<Square> failed = DynamicRefCast<Square>(std::move(moved));
+        passed &= Check(!failed && moved && (shape.RefCount() == 4), "Failed rvalue DynamicRefCast leaves its source");
+
+        Ref<Circle> taken = DynamicRefCast<Circle>(std::move(moved));
+        passed &= Check(taken && !moved && (shape.RefCount() == 4), "Rvalue DynamicRefCast moves the reference");
+
+        Ref<const Circle> constCircle = circle;
+        Ref<Circle> mutableCircle = ConstRefCast<Circle>(constCircle);
+        mutableCircle->Radius = 7;
+        passed &= Check((constCircle->Radius == 7) && (shape.RefCount() == 6), "ConstRefCast");
+    }
+
+    passed &= Check(s_Destroyed == 2, "Cast Refs destroy the object once");
+    return passed;
+}
+
+static bool RunScopeCasts()
+{
+    s_Destroyed = 0;
+    bool passed = true;
+
+    {
+        Scope<Shape> shape = CreateScope<Circle>();
+        Shape* raw = shape.Raw();
+
+        Scope<Square> square = DynamicScopeCast<Square>(std::move(shape));
+        passed &= Check(!square && (shape.Raw() == raw), "Failed DynamicScopeCast leaves its source");
+
+        Scope<Circle> circle = DynamicScopeCast<Circle>(std::move(shape));
+        passed &= Check(circle && !shape && (circle.Raw() == raw), "DynamicScopeCast moves ownership");
+
+        Scope<Shape> back = StaticScopeCast<Shape>(std::move(circle));
+        passed &= Check(back && !circle && (back.Raw() == raw), "StaticScopeCast moves ownership");
+
+        Scope<const Shape> constShape = std::move(back);
+        Scope<Shape> mutableShape = ConstScopeCast<Shape>(std::move(constShape));
+        passed &= Check(mutableShape && !constShape && (mutableShape.Raw() == raw), "ConstScopeCast moves ownership");
+    }
+
+    passed &= Check(s_Destroyed == 2, "Cast Scopes destroy the object once");
+    return passed;
+}
+
+static bool RunTest()
+{
+    bool passed = RunVoid();
+    passed &= RunRefCasts();
+    passed &= RunScopeCasts();
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-RefCasts\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static size_t s_Destroyed = 0;
+
+struct Session : EnableRefFromThis<Session>
+{
+    Session() noexcept = default;
+    Session(const Session&) noexcept = default;
+    virtual ~Session() noexcept { ++s_Destroyed; }
+
+    uint64_t Value = 0;
+};
+
+struct TlsSession : Session
+{
+    uint64_t Key = 0;
+};
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+// An object owned by a Ref hands out Refs and WeakRefs sharing the owner's control block
+static bool RunOwned()
+{
+    s_Destroyed = 0;
+    bool passed = true;
+
+    WeakRef<Session> weak;
+    {
+        Ref<Session> owner = CreateRef<Session>();
+        Ref<Session> self = owner->RefFromThis();
+        weak = owner->WeakFromThis();
+
+        passed &= Check((self == owner) && (owner.RefCount() == 2) && !weak.Expired() && (weak.Lock() == owner), "RefFromThis shares the control block");
+
+        const Session& constSession = *owner;
+        Ref<const Session> constSelf = constSession.RefFromThis();
+        passed &= Check((constSelf.Raw() == owner.Raw()) && (owner.RefCount() == 3) && (constSession.WeakFromThis().Lock() == constSelf), "const RefFromThis");
+
+        // A Ref made from the raw pointer of an owned object joins the existing count instead of owning it twice
+        Ref<Session> fromRaw(owner.Raw());
+        passed &= Check((owner.RefCount() == 4) && (fromRaw == owner), "Ref from an owned raw pointer shares the count");
+    }
+
+    passed &= Check((s_Destroyed == 1) && weak.Expired(), "Destroyed once with the last Ref");
+    return passed;
+}
+
+// The base is hooked by every way of creating an owning Ref, including through a derived type
+static bool RunCreation()
+{
+    s_Destroyed = 0;
+    bool passed = true;
+
+    {
+        Ref<Session> raw(new Session());
+        const bool shared = (raw->RefFromThis() == raw);
+        passed &= Check(shared && raw.Unique(), "Ref(new) hooks RefFromThis");
+
+        Ref<TlsSession> derived = CreateRef<TlsSession>();
+        Ref<Session> base = derived->RefFromThis();
+        passed &= Check((base.Raw() == derived.Raw()) && (derived.RefCount() == 2), "Derived object shares its count");
+
+        std::vector<Ref<Session>> batch = CreateRefs<Session>(4);
+        bool hooked = true;
+        for (const Ref<Session>& ref : batch)
+        {
+            hooked &= (ref->RefFromThis() == ref);
+            hooked &= ref.Unique();
+        }
+
+        passed &= Check(hooked, "CreateRefs hooks RefFromThis");
+    }
+
+    passed &= Check(s_Destroyed == 6, "Every object destroyed once");
+    return passed;
+}
+
+// Objects that no Ref owns, including copies of owned ones, hand out nothing
+static bool RunUnowned()
+{
+    s_Destroyed = 0;
+    bool passed = true;
+
+    {
+        Session local;
+        passed &= Check(!local.RefFromThis() && local.WeakFromThis().Expired(), "Unowned object returns nullptr");
+
+        Ref<Session> owner = CreateRef<Session>();
+        Session copy(*owner);
+        passed &= Check(!copy.RefFromThis() && copy.WeakFromThis().Expired() && owner.Unique(), "Copy of an owned object is not owned");
+
+        Scope<Session> scoped = CreateScope<Session>();
+        passed &= Check(!scoped->RefFromThis(), "Scope-owned object returns nullptr");
+    }
+
+    passed &= Check(s_Destroyed == 4, "Unowned objects are left to their owners");
+    return passed;
+}
+
+static bool RunTest()
+{
+    bool passed = RunOwned();
+    passed &= RunCreation();
+    passed &= RunUnowned();
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-RefFromThis\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
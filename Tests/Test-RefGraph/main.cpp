@@ -0,0 +1,188 @@
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static int64_t s_Live = 0;
+
+struct Node
+{
+    Node() noexcept { ++s_Live; }
+    Node(uint64_t id, const std::string& name) noexcept : Id(id), Name(name) { ++s_Live; }
+    ~Node() noexcept { --s_Live; }
+
+    template<typename _Archive>
+    void Serialize(_Archive& archive)
+    {
+        archive.Field(Id);
+        archive.Field(Name);
+        archive.Field(Children);
+        archive.Field(Next);
+        archive.Field(Parent);
+    }
+
+    uint64_t Id = 0;
+    std::string Name;
+    std::vector<Ref<Node>> Children;
+    Ref<Node> Next;
+    WeakRef<Node> Parent;
+};
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+// Empties the strong back edges, so the cycles can be released
+static void BreakCycles(const std::vector<Ref<Node>>& roots) noexcept
+{
+    for (const Ref<Node>& root : roots)
+    {
+        if (!root)
+            continue;
+
+        for (const Ref<Node>& child : root->Children)
+        {
+            for (const Ref<Node>& grandchild : child->Children)
+                grandchild->Next = nullptr;
+        }
+    }
+}
+
+// root has the children left and right, which share the child shared. shared points back at root through a Ref, which closes
+// a cycle, and at left through a WeakRef. root also observes an object that is not reachable through any Ref.
+static std::vector<Ref<Node>> BuildGraph(const Ref<Node>& unreachable) noexcept
+{
+    Ref<Node> root = CreateRef<Node>(1, "root");
+    Ref<Node> left = CreateRef<Node>(2, "left");
+    Ref<Node> right = CreateRef<Node>(3, std::string(100, 'r'));
+    Ref<Node> shared = CreateRef<Node>(4, "shared");
+
+    root->Children = { left, right };
+    left->Children = { shared };
+    right->Children = { shared };
+    shared->Next = root;
+    shared->Parent = left;
+    root->Parent = unreachable;
+
+    return { root, left, nullptr };
+}
+
+static bool RunRoundTrip(const std::vector<std::byte>& bytes)
+{
+    bool passed = true;
+    const int64_t liveBefore = s_Live;
+
+    std::vector<Ref<Node>> roots = { CreateRef<Node>() };
+    passed &= Check(LoadRefGraph<Node>(bytes, roots) && (roots.size() == 3) && (s_Live == liveBefore + 4), "Loads every object once");
+
+    const Ref<Node>& root = roots[0];
+    const Ref<Node>& left = root->Children[0];
+    const Ref<Node>& right = root->Children[1];
+    const Ref<Node>& shared = left->Children[0];
+
+    passed &= Check((root->Id == 1) && (root->Name == "root") && (right->Name == std::string(100, 'r')) && (shared->Id == 4), "Values are restored");
+    passed &= Check((roots[1] == left) && !roots[2], "Shared and empty roots are restored");
+    passed &= Check((right->Children[0] == shared) && (shared.RefCount() == 2), "Shared node stays shared");
+    passed &= Check((shared->Next == root) && (shared->Parent.Lock() == left), "Cycle and weak edge are reconnected");
+    passed &= Check(!root->Parent.Lock() && !left->Next, "Unreachable weak edge is restored empty");
+
+    BreakCycles(roots);
+    roots.clear();
+    passed &= Check(s_Live == liveBefore, "Loaded graph is released once its cycle is broken");
+    return passed;
+}
+
+static void WriteAt(std::vector<std::byte>& bytes, size_t offset, uint64_t value) noexcept
+{
+    std::memcpy(bytes.data() + offset, &value, sizeof(value));
+}
+
+static bool Rejects(const std::vector<std::byte>& bytes, int64_t liveBefore) noexcept
+{
+    std::vector<Ref<Node>> roots = { CreateRef<Node>() };
+    const bool loaded = LoadRefGraph<Node>(bytes, roots);
+    return !loaded && roots.empty() && (s_Live == liveBefore);
+}
+
+static bool RunCorrupt(const std::vector<std::byte>& bytes)
+{
+    bool passed = true;
+    const int64_t liveBefore = s_Live;
+
+    bool truncated = true;
+    for (size_t size = 0; size < bytes.size(); ++size)
+        truncated &= Rejects(std::vector<std::byte>(bytes.begin(), bytes.begin() + size), liveBefore);
+
+    passed &= Check(truncated, "Every truncation is rejected without leaking");
+
+    // Header: magic, version, object count, root count, then the root indices
+    constexpr size_t versionOffset = sizeof(uint32_t);
+    constexpr size_t objectCountOffset = 2 * sizeof(uint32_t);
+    constexpr size_t rootOffset = objectCountOffset + 2 * sizeof(uint64_t);
+
+    std::vector<std::byte> corrupt = bytes;
+    corrupt[0] = std::byte{ 0 };
+    passed &= Check(Rejects(corrupt, liveBefore), "Wrong magic is rejected");
+
+    corrupt = bytes;
+    corrupt[versionOffset] = std::byte{ 2 };
+    passed &= Check(Rejects(corrupt, liveBefore), "Other version is rejected");
+
+    corrupt = bytes;
+    WriteAt(corrupt, objectCountOffset, UINT64_MAX / 2);
+    passed &= Check(Rejects(corrupt, liveBefore), "Huge object count is rejected before allocating");
+
+    corrupt = bytes;
+    WriteAt(corrupt, rootOffset, 4);
+    passed &= Check(Rejects(corrupt, liveBefore), "Out of range index is rejected");
+
+    // The first object starts with its Id, followed by the length of its Name
+    corrupt = bytes;
+    WriteAt(corrupt, rootOffset + 3 * sizeof(uint64_t) + sizeof(uint64_t), UINT64_MAX);
+    passed &= Check(Rejects(corrupt, liveBefore), "Corrupt string length is rejected");
+
+    // The last field of the last object is a WeakRef index, the objects before it are connected by then, cycle included
+    corrupt = bytes;
+    WriteAt(corrupt, corrupt.size() - sizeof(uint64_t), 1000);
+    passed &= Check(Rejects(corrupt, liveBefore), "Corrupt index after the cycle is connected is rejected without leaking");
+
+    return passed;
+}
+
+static bool RunTest()
+{
+    bool passed = true;
+
+    {
+        Ref<Node> unreachable = CreateRef<Node>(5, "unreachable");
+        std::vector<Ref<Node>> graph = BuildGraph(unreachable);
+
+        const std::vector<std::byte> bytes = SaveRefGraph<Node>(graph);
+        BreakCycles(graph);
+        graph.clear();
+        passed &= Check(!bytes.empty() && (s_Live == 1), "Saved graph is released once its cycle is broken");
+
+        passed &= RunRoundTrip(bytes);
+        passed &= RunCorrupt(bytes);
+    }
+
+    passed &= Check(s_Live == 0, "Every object destroyed");
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-RefGraph\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static int64_t s_Live = 0;
+
+struct Item
+{
+    explicit Item(uint64_t id) noexcept : Id(id) { ++s_Live; }
+    ~Item() noexcept { --s_Live; }
+
+    uint64_t Id;
+};
+
+static constexpr size_t ITEM_COUNT = 1000;
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static std::vector<Ref<Item>> CreateItems(size_t count)
+{
+    std::vector<Ref<Item>> items;
+    for (size_t i = 0; i < count; ++i)
+        items.push_back(CreateRef<Item>(i));
+
+    return items;
+}
+
+// Deterministic shuffle, so erasures hit clusters in an order unrelated to insertion
+static std::vector<size_t> ShuffledOrder(size_t count)
+{
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; ++i)
+        order[i] = i;
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (size_t i = count - 1; i > 0; --i)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        std::swap(order[i], order[(state >> 33) % (i + 1)]);
+    }
+
+    return order;
+}
+
+static std::string NameOf(uint64_t id)
+{
+    return "item number " + std::to_string(id) + " with a name that is not stored inline";
+}
+
+// A table filled to its 3/4 load factor has long clusters, every erase must leave the rest reachable from their home slots
+static bool RunBackshift()
+{
+    bool passed = true;
+    std::vector<Ref<Item>> items = CreateItems(12);
+
+    {
+        RefHashSet<Item> set;
+        RefHashMap<Item, std::string> map;
+        for (const Ref<Item>& item : items)
+        {
+            set.Insert(item);
+            map[item] = NameOf(item->Id);
+        }
+
+        passed &= Check((set.Capacity() == 16) && (map.Capacity() == 16) && (items[0].RefCount() == 3), "Filled to the load factor without rehashing");
+
+        std::vector<bool> erased(items.size(), false);
+        bool found = true;
+        for (size_t i : ShuffledOrder(items.size()))
+        {
+            found &= set.Erase(items[i].Raw()) && map.Erase(items[i].Raw()) && !set.Erase(items[i].Raw());
+            erased[i] = true;
+
+            for (size_t k = 0; k < items.size(); ++k)
+            {
+                const std::string* name = map.Find(items[k].Raw());
+                found &= (set.Contains(items[k].Raw()) != erased[k]);
+                found &= erased[k] ? !name : (name && (*name == NameOf(k)));
+                found &= (items[k].RefCount() == (erased[k] ? 1u : 3u));
+            }
+        }
+
+        passed &= Check(found && set.Empty() && map.Empty(), "Lookups after every erase");
+    }
+
+    return passed;
+}
+
+static bool RunRehash()
+{
+    bool passed = true;
+    std::vector<Ref<Item>> items = CreateItems(ITEM_COUNT);
+
+    {
+        RefHashSet<Item> set;
+        RefHashMap<Item, std::string> map;
+
+        size_t rehashes = 0;
+        for (const Ref<Item>& item : items)
+        {
+            const size_t capacity = map.Capacity();
+            set.Insert(item);
+            map.Emplace(item, NameOf(item->Id));
+            rehashes += (map.Capacity() != capacity);
+        }
+
+        passed &= Check((rehashes > 5) && (set.Size() == ITEM_COUNT) && (map.Size() == ITEM_COUNT) && (map.Size() * 4 <= map.Capacity() * 3), "Growing keeps the load factor");
+        passed &= Check(!set.Insert(items[7]) && !map.Emplace(items[7], "other").second && (*map.Find(items[7].Raw()) == NameOf(7)), "Inserting a present key changes nothing");
+
+        // Erase two thirds, then grow again so the survivors are rehashed after the erasures
+        for (size_t i = 0; i < ITEM_COUNT; ++i)
+        {
+            if ((i % 3) != 0)
+                (void)(set.Erase(items[i].Raw()) && map.Erase(items[i].Raw()));
+        }
+
+        const size_t capacity = map.Capacity();
+        map.Reserve(capacity * 2);
+        set.Reserve(capacity * 2);
+
+        bool found = (map.Capacity() > capacity);
+        for (size_t i = 0; i < ITEM_COUNT; ++i)
+        {
+            const std::string* name = map.Find(items[i].Raw());
+            found &= (set.Contains(items[i].Raw()) == ((i % 3) == 0));
+            found &= ((i % 3) == 0) ? (name && (*name == NameOf(i))) : !name;
+        }
+
+        passed &= Check(found && (set.Size() == (ITEM_COUNT + 2) / 3), "Lookups after erasing and rehashing");
+
+        Ref<Item> extracted = set.Extract(items[0].Raw());
+        passed &= Check((extracted == items[0]) && !set.Contains(items[0].Raw()) && (items[0].RefCount() == 3), "Extract hands over the reference");
+
+        RefHashSet<Item> copy = set;
+        passed &= Check((copy.Size() == set.Size()) && copy.Contains(items[3].Raw()) && (items[3].RefCount() == 4), "Copy retains every element");
+
+        map.Clear();
+        passed &= Check(map.Empty() && !map.Find(items[3].Raw()) && (items[3].RefCount() == 3), "Clear releases every element");
+    }
+
+    items.clear();
+    passed &= Check(s_Live == 0, "Every object destroyed");
+    return passed;
+}
+
+// Standard containers keyed on smart pointers, searched with raw pointers and other smart pointers without a temporary Ref
+static bool RunTransparent()
+{
+    bool passed = true;
+    std::vector<Ref<Item>> items = CreateItems(64);
+
+    {
+        std::unordered_set<Ref<Item>, RefHash<Item>, RefEqual<Item>> set(items.begin(), items.end());
+        Ref<Item> outsider = CreateRef<Item>(ITEM_COUNT);
+
+        bool found = true;
+        for (const Ref<Item>& item : items)
+        {
+            auto it = set.find(item.Raw());
+            found &= (it != set.end()) && (*it == item) && (set.count(WeakRef<Item>(item)) == 1);
+        }
+
+        passed &= Check(found && (items[0].RefCount() == 2), "Ref set found by raw pointer and WeakRef");
+        passed &= Check((set.find(outsider.Raw()) == set.end()) && !set.contains(static_cast<const Item*>(nullptr)), "Absent pointers are not found");
+
+        std::unordered_map<WeakRef<Item>, uint64_t, RefHash<Item>, RefEqual<Item>> ids;
+        for (const Ref<Item>& item : items)
+            ids.emplace(item, item->Id);
+
+        auto it = ids.find(items[5]);
+        passed &= Check((it != ids.end()) && (it->second == 5) && (ids.find(items[9].Raw())->second == 9) && (items[5].RefCount() == 2), "WeakRef map found by Ref and raw pointer");
+
+        std::unordered_set<Scope<Item>, RefHash<Item>, RefEqual<Item>> scopes;
+        Item* raw = scopes.insert(CreateScope<Item>(ITEM_COUNT + 1)).first->Raw();
+        passed &= Check(scopes.contains(raw) && !scopes.contains(items[0].Raw()), "Scope set found by raw pointer");
+
+        passed &= Check((RefHash<Item>{}(items[3].Raw()) == std::hash<Ref<Item>>{}(items[3])) && (RefHash<Item>{}(WeakRef<Item>(items[3])) == std::hash<Ref<Item>>{}(items[3])), "RefHash matches std::hash of the smart pointers");
+    }
+
+    items.clear();
+    passed &= Check(s_Live == 0, "Every object destroyed");
+    return passed;
+}
+
+static bool RunTest()
+{
+    bool passed = RunBackshift();
+    passed &= RunRehash();
+    passed &= RunTransparent();
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-RefHashTable\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
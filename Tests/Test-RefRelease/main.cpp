@@ -0,0 +1,118 @@
+#include <iostream>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static size_t s_Destroyed = 0;
+
+struct Header
+{
+    uint64_t Id = 1;
+};
+
+struct Base
+{
+    ~Base() noexcept { ++s_Destroyed; }
+
+    uint64_t Value = 2;
+};
+
+// Base sits at a non-zero offset, so a Base* is not the pointer new returned
+struct Derived : Header, Base
+{
+    ~Derived() noexcept { ++s_Destroyed; }
+
+    uint64_t Extra = 3;
+};
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+// Refs to the object itself, as the type it was created as, hand it over
+static bool RunReleased()
+{
+    bool passed = true;
+
+    s_Destroyed = 0;
+    Ref<Derived> ref = CreateRef<Derived>();
+    Derived* raw = ref.Raw();
+    Derived* released = ref.Release();
+    passed &= Check((released == raw) && !ref && (s_Destroyed == 0), "Release() hands over a created object");
+    delete released;
+    passed &= Check(s_Destroyed == 2, "Released object is deleted by the caller");
+
+    s_Destroyed = 0;
+    Ref<const Derived> constRef(new Derived());
+    const Derived* constReleased = constRef.Release();
+    passed &= Check(constReleased && !constRef && (s_Destroyed == 0), "Release() of a Ref to const");
+    delete constReleased;
+
+    // Casting back to the created type restores the pointer new returned
+    s_Destroyed = 0;
+    Ref<Base> base = CreateRef<Derived>();
+    Ref<Derived> derived = StaticRefCast<Derived>(std::move(base));
+    Derived* castBack = derived.Release();
+    passed &= Check(castBack && !derived && (s_Destroyed == 0), "Release() after casting back to the created type");
+    delete castBack;
+
+    passed &= Check(!Ref<Derived>().Release(), "Release() of an empty Ref");
+    return passed;
+}
+
+// Every Ref whose pointer the caller could not delete keeps its reference
+static bool RunRefused()
+{
+    bool passed = true;
+    s_Destroyed = 0;
+
+    {
+        Ref<Derived> owner = CreateRef<Derived>();
+
+        // Converted to a base at a non-zero offset and without a virtual destructor
+        Ref<Base> base = owner;
+        owner.Reset();
+        passed &= Check(!base.Release() && base && base.Unique(), "Base Ref is refused");
+
+        // Created as Derived through a Ref to its base
+        Ref<Base> fromNew(new Derived());
+        passed &= Check(!fromNew.Release() && fromNew && fromNew.Unique(), "Base Ref of a new derived object is refused");
+
+        // Pointing at a member of the owned object
+        Ref<uint64_t> member(fromNew, &fromNew->Value);
+        passed &= Check(!member.Release() && member && (fromNew.RefCount() == 2), "Aliasing Ref is refused");
+
+        Ref<Base> cast = StaticRefCast<Base>(CreateRef<Derived>());
+        passed &= Check(!cast.Release() && cast && cast.Unique(), "Cast Ref is refused");
+
+        Ref<void> erased = CreateRef<Derived>();
+        passed &= Check(!erased.Release() && erased && erased.Unique(), "Ref<void> is refused");
+
+        passed &= Check(s_Destroyed == 0, "Refused Refs keep their objects");
+    }
+
+    // Every object is destroyed as a Derived by its control block
+    passed &= Check(s_Destroyed == 8, "Refused objects are destroyed with their last Ref");
+    return passed;
+}
+
+static bool RunTest()
+{
+    bool passed = RunReleased();
+    passed &= RunRefused();
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-RefRelease\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+// Depth-first IDs: Node 0, Expr 1, Literal 2, Call 3, Stmt 4
+struct Node
+{
+    virtual ~Node() noexcept = default;
+    virtual uint32_t GetRefTypeId() const noexcept { return 0; }
+};
+
+struct Expr : Node
+{
+    uint32_t GetRefTypeId() const noexcept override { return 1; }
+};
+
+struct Literal : Expr
+{
+    uint32_t GetRefTypeId() const noexcept override { return 2; }
+
+    uint64_t Value = 42;
+};
+
+struct Call : Expr
+{
+    uint32_t GetRefTypeId() const noexcept override { return 3; }
+};
+
+struct Stmt : Node
+{
+    uint32_t GetRefTypeId() const noexcept override { return 4; }
+};
+
+template<> struct Intricate::RefTypeInfo<Node>    { static constexpr uint32_t First = 0, Last = 4; };
+template<> struct Intricate::RefTypeInfo<Expr>    { static constexpr uint32_t First = 1, Last = 3; };
+template<> struct Intricate::RefTypeInfo<Literal> { static constexpr uint32_t First = 2, Last = 2; };
+template<> struct Intricate::RefTypeInfo<Call>    { static constexpr uint32_t First = 3, Last = 3; };
+template<> struct Intricate::RefTypeInfo<Stmt>    { static constexpr uint32_t First = 4, Last = 4; };
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static bool RunRefCasts()
+{
+    bool passed = true;
+    Ref<Node> node = CreateRef<Literal>();
+
+    Ref<Literal> literal = RefCast<Literal>(node);
+    Ref<Expr> expr = RefCast<Expr>(node);
+    passed &= Check(literal && (literal->Value == 42) && expr && (node.RefCount() == 3), "Downcast to the class and to its base");
+
+    Ref<Stmt> stmt = RefCast<Stmt>(node);
+    Ref<Call> call = RefCast<Call>(expr);
+    passed &= Check(!stmt && !call && (node.RefCount() == 3), "Wrong-type cast returns nullptr");
+
+    Ref<Node> source = node;
+    Ref<Stmt> failed = RefCast<Stmt>(std::move(source));
+    passed &= Check(!failed && source && (node.RefCount() == 4), "Wrong-type rvalue cast leaves its source");
+
+    Ref<Literal> moved = RefCast<Literal>(std::move(source));
+    passed &= Check(moved && !source && (node.RefCount() == 4), "Rvalue cast moves the reference");
+
+    Ref<Node> up = RefCast<Node>(literal);
+    passed &= Check((up == node) && !RefCast<Literal>(Ref<Node>()), "Upcast and empty source");
+
+    return passed;
+}
+
+static bool RunWeakRefCasts()
+{
+    bool passed = true;
+    Ref<Node> node = CreateRef<Call>();
+    WeakRef<Node> weak = node;
+
+    WeakRef<Call> call = RefCast<Call>(weak);
+    WeakRef<Literal> literal = RefCast<Literal>(weak);
+    passed &= Check(!call.Expired() && (call.Lock() == node) && literal.Expired(), "WeakRef downcast and wrong-type cast");
+
+    node.Reset();
+    passed &= Check(RefCast<Call>(weak).Expired() && call.Expired(), "Expired WeakRef casts to an empty one");
+
+    return passed;
+}
+
+static bool RunScopeCasts()
+{
+    Scope<Node> node = CreateScope<Stmt>();
+    Node* raw = node.Raw();
+
+    Scope<Expr> expr = RefCast<Expr>(std::move(node));
+    bool passed = Check(!expr && (node.Raw() == raw), "Wrong-type Scope cast leaves its source");
+
+    Scope<Stmt> stmt = RefCast<Stmt>(std::move(node));
+    passed &= Check(stmt && !node && (stmt.Raw() == raw), "Scope cast moves ownership");
+
+    return passed;
+}
+
+static bool RunTest()
+{
+    bool passed = RunRefCasts();
+    passed &= RunWeakRefCasts();
+    passed &= RunScopeCasts();
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-RefTypeInfo\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static int64_t s_Live = 0;
+
+struct HeapObject
+{
+    explicit HeapObject(uint64_t value) noexcept : Value(value), Name("object number " + std::to_string(value) + " with a heap-allocated name") { ++s_Live; }
+    HeapObject(HeapObject&& other) noexcept : Value(other.Value), Name(std::move(other.Name)) { ++s_Live; }
+    ~HeapObject() noexcept { --s_Live; }
+
+    bool Matches(uint64_t value) const noexcept
+    {
+        return (Value == value) && (Name == "object number " + std::to_string(value) + " with a heap-allocated name");
+    }
+
+    uint64_t Value;
+    std::string Name;
+};
+
+using SmallHeap = RelocatableHeap<HeapObject, 4096>;
+
+static constexpr uint64_t OBJECT_COUNT = 1000;
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static bool RunTest()
+{
+    bool passed = true;
+
+    {
+        SmallHeap heap;
+        std::vector<Handle<HeapObject>> handles;
+        for (uint64_t i = 0; i < OBJECT_COUNT; ++i)
+            handles.push_back(heap.Emplace(i));
+
+        const size_t fullPages = heap.GetStats().Pages;
+
+        // Keep every eighth object, which leaves every page sparse
+        std::vector<uint64_t> kept;
+        for (uint64_t i = 0; i < OBJECT_COUNT; ++i)
+        {
+            if ((i % 8) != 0)
+                (void)heap.Erase(handles[i]);
+            else
+                kept.push_back(i);
+        }
+
+        passed &= Check((fullPages > 8) && (heap.Size() == kept.size()) && (heap.GetStats().Pages == fullPages) && (s_Live == static_cast<int64_t>(kept.size())), "Erasing leaves the pages allocated");
+
+        // Pin an object that would otherwise be moved out of its page
+        const uint64_t pinnedIdx = kept[1];
+        Pinned<HeapObject> pinned = heap.Pin(handles[pinnedIdx]);
+        HeapObject* pinnedAddress = pinned.Raw();
+
+        std::vector<HeapObject*> before;
+        for (uint64_t i : kept)
+            before.push_back(heap.Get(handles[i]));
+
+        // A budget of one moves a single object
+        CompactionStats single = heap.Compact(1);
+        passed &= Check(single.MovedObjects == 1, "Compact respects its budget");
+
+        CompactionStats stats = heap.Compact(SIZE_MAX);
+        const RelocatableHeapStats heapStats = heap.GetStats();
+
+        size_t moved = 0;
+        bool resolved = true;
+        for (size_t k = 0; k < kept.size(); ++k)
+        {
+            HeapObject* obj = heap.Get(handles[kept[k]]);
+            resolved &= obj && obj->Matches(kept[k]);
+            moved += (obj != before[k]);
+        }
+
+        passed &= Check((stats.MovedObjects > 0) && (moved > 0) && (stats.ReleasedPages > 0) && (heapStats.Pages < fullPages), "Compact moves objects and releases pages");
+        passed &= Check(resolved && (heap.Size() == kept.size()) && (s_Live == static_cast<int64_t>(kept.size())), "Handles resolve to the moved objects");
+        passed &= Check((heap.Get(handles[pinnedIdx]) == pinnedAddress) && (pinned.Raw() == pinnedAddress) && pinned->Matches(pinnedIdx), "Pinned object stays in place");
+
+        // Once unpinned, the object can be moved like any other
+        pinned = nullptr;
+        (void)heap.Compact(SIZE_MAX);
+        passed &= Check(heap.Get(handles[pinnedIdx])->Matches(pinnedIdx) && (heap.GetStats().Pages <= heapStats.Pages), "Unpinned object can be compacted");
+
+        passed &= Check(!heap.Contains(handles[1]) && !heap.Get(handles[1]) && !heap.Pin(handles[1]), "Erased handles stay stale across compaction");
+    }
+
+    passed &= Check(s_Live == 0, "Destroying the heap destroys every object");
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-RelocatableHeap\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
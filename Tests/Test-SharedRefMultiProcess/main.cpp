@@ -0,0 +1,173 @@
+#include <iostream>
+#include <IntricatePointers/IntricatePointers.hpp>
+#ifdef _INTRICATE_POSIX
+    #include <sys/wait.h>
+#endif
+using namespace Intricate;
+
+
+#ifdef _INTRICATE_POSIX
+struct SharedNode
+{
+    uint64_t Value = 0;
+    uint64_t Next = 0;      // Offset of the next node in the heap
+};
+
+static constexpr const char* HEAP_NAME = "/Test-SharedRefMultiProcess";
+static constexpr size_t HEAP_SIZE = 4 << 20;
+static constexpr int WORKER_COUNT = 16;
+static constexpr int CRASHING_WORKER = 5;
+static constexpr size_t WORKER_ITERS = 10'000;
+static constexpr uint64_t OFFSET_MASK = (uint64_t(1) << 48) - 1;  // The generation of the block sits above it
+
+// Every worker walks the list published by the parent, copies and drops Refs to it, and creates and frees objects of its own
+static int RunWorker(int workerIdx) noexcept
+{
+    SharedHeap heap(HEAP_NAME, 0);
+    if (!heap)
+        return 1;
+
+    Ref<SharedNode> head = heap.Acquire<SharedNode>(heap.GetRoot());
+    if (!head)
+        return 2;
+
+    for (size_t i = 0; i < WORKER_ITERS; ++i)
+    {
+        uint64_t sum = 0;
+        for (Ref<SharedNode> node = head; node; node = heap.Acquire<SharedNode>(node->Next))
+            sum += node->Value;
+
+        if (sum != 45)
+            return 3;
+
+        Ref<SharedNode> own = heap.Create<SharedNode>(SharedNode{ i, 0 });
+        Ref<SharedNode> copy = heap.Acquire<SharedNode>(heap.OffsetOf(own.Raw()));
+        if (!own || (copy.Raw() != own.Raw()) || (own.RefCount() != 2))
+            return 4;
+    }
+
+    // Dies without releasing anything, leaving its holdings to RecoverDeadProcesses()
+    if (workerIdx == CRASHING_WORKER)
+    {
+        Ref<SharedNode>* leaked = new Ref<SharedNode>(heap.Create<SharedNode>(SharedNode{ 99, 0 }));
+        (void)leaked;
+        _exit(0);
+    }
+
+    return 0;
+}
+
+// Offsets that do not lead to a live object of the generation they were taken from, checked from another process
+struct StaleOffsets
+{
+    uint64_t Freed;         // Of an object whose block now holds another one
+    uint64_t Untagged;      // The same block without its generation
+    uint64_t Interior;      // Into the middle of the live object
+    uint64_t Beyond;        // Past the end of the heap
+    uint64_t Live;
+};
+
+static int RunStaleChecker(const StaleOffsets& offsets) noexcept
+{
+    SharedHeap heap(HEAP_NAME, 0);
+    if (!heap)
+        return 1;
+
+    if (heap.Acquire<SharedNode>(offsets.Freed) || heap.Acquire<SharedNode>(offsets.Untagged) || heap.Acquire<SharedNode>(offsets.Interior) ||
+        heap.Acquire<SharedNode>(offsets.Beyond))
+        return 2;
+
+    Ref<SharedNode> live = heap.Acquire<SharedNode>(offsets.Live);
+    return (live && (live->Value == 2)) ? 0 : 3;
+}
+
+static bool RunStaleOffsets(SharedHeap& heap) noexcept
+{
+    Ref<SharedNode> freed = heap.Create<SharedNode>(SharedNode{ 1, 0 });
+    StaleOffsets offsets{};
+    offsets.Freed = heap.OffsetOf(freed.Raw());
+    freed = nullptr;
+
+    // Reuses the block that was just freed
+    Ref<SharedNode> live = heap.Create<SharedNode>(SharedNode{ 2, 0 });
+    offsets.Live = heap.OffsetOf(live.Raw());
+    offsets.Untagged = offsets.Live & OFFSET_MASK;
+    offsets.Interior = offsets.Live + 16;
+    offsets.Beyond = HEAP_SIZE + 64;
+
+    const bool reused = (offsets.Untagged == (offsets.Freed & OFFSET_MASK)) && (offsets.Live != offsets.Freed);
+
+    const pid_t pid = fork();
+    if (pid == 0)
+        _exit(RunStaleChecker(offsets));
+
+    int status = 0;
+    const bool passed = reused && (waitpid(pid, &status, 0) == pid) && WIFEXITED(status) && (WEXITSTATUS(status) == 0) && !heap.Acquire<SharedNode>(offsets.Freed);
+    std::cout << "Stale offsets rejected: " << (passed ? "OK" : "FAILED") << '\n';
+
+    return passed;
+}
+
+static bool RunTest() noexcept
+{
+    SharedHeap::Unlink(HEAP_NAME);
+    SharedHeap heap(HEAP_NAME, HEAP_SIZE);
+    if (!heap)
+    {
+        std::cout << "Failed to create the shared heap\n";
+        return false;
+    }
+
+    // A list of the values 0 to 9, offsets do not hold objects so the parent keeps a Ref to every node
+    std::vector<Ref<SharedNode>> nodes;
+    for (uint64_t i = 0; i < 10; ++i)
+        nodes.push_back(heap.Create<SharedNode>(SharedNode{ i, nodes.empty() ? 0 : heap.OffsetOf(nodes.back().Raw()) }));
+
+    heap.SetRoot(heap.OffsetOf(nodes.back().Raw()));
+
+    for (int i = 0; i < WORKER_COUNT; ++i)
+    {
+        if (fork() == 0)
+            _exit(RunWorker(i));
+    }
+
+    bool passed = true;
+    int status = 0;
+    while (wait(&status) > 0)
+        passed &= WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+
+    std::cout << "Workers finished: " << (passed ? "OK" : "FAILED") << '\n';
+
+    passed &= RunStaleOffsets(heap);
+
+    uint32_t recovered = heap.RecoverDeadProcesses();
+    SharedHeapStats stats = heap.GetStats();
+    std::cout << "Recovered processes: " << recovered << '\n';
+    std::cout << "Live objects: " << stats.LiveObjects << ", processes: " << stats.Processes << '\n';
+    passed &= (recovered == 1) && (stats.LiveObjects == nodes.size()) && (stats.Processes == 1);
+
+    nodes.clear();
+    stats = heap.GetStats();
+    std::cout << "Live objects after release: " << stats.LiveObjects << '\n';
+    passed &= (stats.LiveObjects == 0) && !heap.Acquire<SharedNode>(heap.GetRoot());
+
+    SharedHeap::Unlink(HEAP_NAME);
+    return passed;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-SharedRefMultiProcess\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+#ifdef _INTRICATE_POSIX
+    std::cout << (RunTest() ? "PASSED\n" : "FAILED\n");
+#else
+    std::cout << "SharedHeap requires POSIX shared memory\n";
+#endif
+
+    std::cin.get();
+    return 0;
+}
@@ -0,0 +1,26 @@
+project "Test-SharedRefMultiProcess"
+    kind "ConsoleApp"
+    language "C++"
+
+    debugdir(OUT_DIR)
+    targetdir(OUT_DIR)
+    objdir(INT_DIR)
+
+    files
+    {
+        "./*.hpp",
+        "./*.cpp"
+    }
+
+    includedirs
+    {
+        ".",
+        "%{INTRICATE_POINTERS_HPP_INCLUDE}"
+    }
+
+    filter "system:linux"
+        links
+        {
+            "rt",
+            "pthread"
+        }
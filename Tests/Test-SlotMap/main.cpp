@@ -0,0 +1,58 @@
+#include <iostream>
+#include <string>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static bool RunTest()
+{
+    SlotMap<std::string> map;
+
+    Handle<std::string> first = map.Emplace("first");
+    Handle<std::string> second = map.Emplace("second");
+    Handle<std::string> third = map.Emplace("third");
+
+    bool passed = Check(first && second && third && (map.Size() == 3) && (*map.Get(second) == "second"), "Emplace");
+
+    // Erasing moves the last object into the hole, the other handles keep resolving to their own objects
+    const bool erased = map.Erase(first);
+    passed &= Check(erased && (map.Size() == 2) && (*map.Get(second) == "second") && (*map.Get(third) == "third"), "Erase keeps other handles");
+    passed &= Check(!map.Contains(first) && !map.Get(first) && !map.Erase(first), "Erased handle is stale");
+
+    // The freed slot is reused with a new generation that the stale handle does not match
+    Handle<std::string> reused = map.Emplace("reused");
+    passed &= Check((reused.Index() == first.Index()) && (reused.Generation() != first.Generation()) && (reused != first), "Reused slot gets a new generation");
+    passed &= Check(!map.Contains(first) && !map.Get(first) && (*map.Get(reused) == "reused") && (map.Size() == 3), "Stale handle misses the reused slot");
+    passed &= Check(!map.Erase(first) && map.Contains(reused), "Stale handle cannot erase the reused slot");
+
+    // Extracting moves the object into a Ref and invalidates the handle
+    Ref<std::string> extracted = map.ExtractRef(second);
+    passed &= Check(extracted && (*extracted == "second") && !map.Contains(second) && (map.Size() == 2), "ExtractRef");
+
+    map.Clear();
+    passed &= Check(map.Empty() && !map.Contains(third) && !map.Contains(reused), "Clear invalidates every handle");
+
+    Handle<std::string> afterClear = map.Emplace("after");
+    passed &= Check(!map.Contains(third) && !map.Contains(reused) && (*map.Get(afterClear) == "after"), "Handles stay stale after reuse");
+
+    passed &= Check(!Handle<std::string>() && !map.Contains(nullptr), "Null handle");
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-SlotMap\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
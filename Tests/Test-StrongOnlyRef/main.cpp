@@ -0,0 +1,134 @@
+#include <iostream>
+#include <cstdlib>
+#include <IntricatePointers/IntricatePointers.hpp>
+using namespace Intricate;
+
+
+// Counts the live allocations, so the tests can tell that every control block was freed
+static size_t s_Allocations = 0;
+
+void* operator new(size_t size)
+{
+    ++s_Allocations;
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    ++s_Allocations;
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr)
+    {
+        --s_Allocations;
+        std::free(ptr);
+    }
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+static size_t s_Destroyed = 0;
+
+struct StrongOnly
+{
+    ~StrongOnly() noexcept { ++s_Destroyed; }
+
+    uint64_t Value = 0;
+};
+
+struct StrongOnlyDerived : StrongOnly
+{
+    ~StrongOnlyDerived() noexcept { ++s_Destroyed; }
+};
+
+struct StrongOnlyDeferred
+{
+    ~StrongOnlyDeferred() noexcept { ++s_Destroyed; }
+};
+
+struct Observed
+{
+    uint64_t Value = 0;
+};
+
+template<> struct Intricate::EnableWeakRefs<StrongOnly> : std::false_type { };
+template<> struct Intricate::EnableWeakRefs<StrongOnlyDerived> : std::false_type { };
+template<> struct Intricate::EnableWeakRefs<StrongOnlyDeferred> : std::false_type { };
+template<> struct Intricate::DeferRefDestruction<StrongOnlyDeferred> : std::true_type { };
+
+// A strong-only type gets the control block without a weak count, while every other type keeps the weak one
+static_assert(std::is_same_v<_RefCountType<StrongOnly>, _AtomicStrongRefCount>);
+static_assert(std::is_same_v<_RefCountType<const StrongOnly>, _AtomicStrongRefCount>);
+static_assert(std::is_same_v<_RefCountType<Observed>, _AtomicRefCount>);
+static_assert(std::is_same_v<decltype(_RefAccess::GetRefCount(std::declval<const Ref<StrongOnly>&>())), _AtomicStrongRefCount*>);
+
+static bool Check(bool passed, const char* what) noexcept
+{
+    std::cout << what << ": " << (passed ? "OK" : "FAILED") << '\n';
+    return passed;
+}
+
+static bool RunTest()
+{
+    bool passed = true;
+
+    {
+        const size_t allocations = s_Allocations;
+        s_Destroyed = 0;
+
+        Ref<StrongOnly> ref = CreateRef<StrongOnly>();
+        Ref<StrongOnly> copy = ref;
+        const bool shared = (ref.RefCount() == 2) && (copy.Raw() == ref.Raw());
+
+        ref.Reset();
+        const bool alive = (s_Destroyed == 0) && copy.Unique();
+
+        copy.Reset();
+        passed &= Check(shared && alive && (s_Destroyed == 1) && (s_Allocations == allocations), "Final release destroys and frees");
+    }
+
+    {
+        const size_t allocations = s_Allocations;
+        s_Destroyed = 0;
+
+        // Destroyed as the type it was created as through the strong-only block of its base
+        Ref<StrongOnly> base(new StrongOnlyDerived());
+        base.Reset();
+        passed &= Check((s_Destroyed == 2) && (s_Allocations == allocations), "Base Ref destroys the derived object");
+    }
+
+    {
+        const size_t allocations = s_Allocations;
+        s_Destroyed = 0;
+
+        Ref<StrongOnlyDeferred> ref = CreateRef<StrongOnlyDeferred>();
+        ref.Reset();
+        const bool deferred = (s_Destroyed == 0);
+
+        (void)DrainDeferred();
+        passed &= Check(deferred && (s_Destroyed == 1) && (s_Allocations == allocations), "Deferred final release");
+    }
+
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "----------------------------------------------------------------\n";
+    std::cout << "Test-StrongOnlyRef\n";
+    std::cout << "----------------------------------------------------------------\n\n";
+
+    std::cout << (RunTest() ? "\nPASSED\n" : "\nFAILED\n");
+
+    std::cin.get();
+    return 0;
+}
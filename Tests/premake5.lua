@@ -84,6 +84,24 @@ workspace "Tests"
             "NoIncrementalLink"
         }
 
+include "Test-CompactWeakRef"
+include "Test-CreateRefs"
+include "Test-DeferredDestruction"
+include "Test-InlineScope"
+include "Test-LockAll"
+include "Test-OffsetRefMapping"
+include "Test-RefBaseDestruction"
+include "Test-RefBufferChain"
+include "Test-RefCasts"
+include "Test-RefFromThis"
+include "Test-RefGraph"
+include "Test-RefHashTable"
 include "Test-RefMemoryLeak"
+include "Test-RefRelease"
+include "Test-RefTypeInfo"
+include "Test-RelocatableHeap"
 include "Test-ScopeMemoryLeak"
+include "Test-SharedRefMultiProcess"
+include "Test-SlotMap"
+include "Test-StrongOnlyRef"
 include "Test-WeakRefMemoryLeak"
@@ -1,6 +1,7 @@
 include "Vendor/premake/customization/solutionitems.lua"
 include "Examples"
 include "Tests"
+include "Benchmarks"
 
 OUT_DIR = "%{wks.location}/bin/build/%{cfg.system}/%{cfg.architecture}/%{cfg.buildcfg}"
 INT_DIR = "%{wks.location}/bin/intermediate/%{cfg.system}/%{cfg.architecture}/%{cfg.buildcfg}/%{prj.name}"